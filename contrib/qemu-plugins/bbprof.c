@@ -0,0 +1,125 @@
+/*
+ * Basic block execution profile for qemu-user.
+ *
+ * Counts how often every translated block is executed and writes one line
+ * per block to the file given with out=<path> (default bbprof.out) when
+ * the program exits:
+ *
+ *   <vaddr> <size in bytes> <instructions> <executions>
+ *
+ * scripts/riscv-profile symbolizes the result against the ELF file.
+ *
+ * Usage: qemu-riscv64 -plugin libbbprof.so,out=<path> <program>
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+#include <qemu-plugin.h>
+
+QEMU_PLUGIN_EXPORT int qemu_plugin_version = QEMU_PLUGIN_VERSION;
+
+typedef struct
+{
+  uint64_t vaddr;
+  uint64_t size;
+  uint64_t insns;
+  uint64_t count;
+} BlockInfo;
+
+static GHashTable *blocks;
+static GMutex lock;
+static char *out_path;
+
+static void
+vcpu_tb_exec (unsigned int cpu_index, void *udata)
+{
+  BlockInfo *bb = udata;
+
+  __atomic_fetch_add (&bb->count, 1, __ATOMIC_RELAXED);
+}
+
+static void
+vcpu_tb_trans (qemu_plugin_id_t id, struct qemu_plugin_tb *tb)
+{
+  uint64_t vaddr = qemu_plugin_tb_vaddr (tb);
+  size_t insns = qemu_plugin_tb_n_insns (tb);
+  struct qemu_plugin_insn *last = qemu_plugin_tb_get_insn (tb, insns - 1);
+  /* A block may be retranslated, or split differently when it is entered
+     in the middle; blocks are identified by start address and length so
+     retranslations share one counter.  */
+  uint64_t key = vaddr ^ ((uint64_t) insns << 48);
+  BlockInfo *bb;
+
+  g_mutex_lock (&lock);
+  bb = g_hash_table_lookup (blocks, (gconstpointer) (uintptr_t) key);
+  if (!bb)
+    {
+      bb = g_new0 (BlockInfo, 1);
+      bb->vaddr = vaddr;
+      bb->insns = insns;
+      bb->size = qemu_plugin_insn_vaddr (last)
+		 + qemu_plugin_insn_size (last) - vaddr;
+      g_hash_table_insert (blocks, (gpointer) (uintptr_t) key, bb);
+    }
+  g_mutex_unlock (&lock);
+
+  qemu_plugin_register_vcpu_tb_exec_cb (tb, vcpu_tb_exec,
+					QEMU_PLUGIN_CB_NO_REGS, bb);
+}
+
+static void
+plugin_exit (qemu_plugin_id_t id, void *p)
+{
+  GHashTableIter iter;
+  gpointer value;
+  FILE *out = fopen (out_path, "w");
+
+  if (!out)
+    {
+      perror (out_path);
+      return;
+    }
+
+  g_mutex_lock (&lock);
+  g_hash_table_iter_init (&iter, blocks);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      BlockInfo *bb = value;
+      if (bb->count)
+	fprintf (out, "0x%016" PRIx64 " %" PRIu64 " %" PRIu64 " %" PRIu64 "\n",
+		 bb->vaddr, bb->size, bb->insns, bb->count);
+    }
+  g_mutex_unlock (&lock);
+  fclose (out);
+}
+
+QEMU_PLUGIN_EXPORT int
+qemu_plugin_install (qemu_plugin_id_t id, const qemu_info_t *info,
+		     int argc, char **argv)
+{
+  int i;
+
+  out_path = g_strdup ("bbprof.out");
+  for (i = 0; i < argc; i++)
+    {
+      if (strncmp (argv[i], "out=", 4) == 0)
+	{
+	  g_free (out_path);
+	  out_path = g_strdup (argv[i] + 4);
+	}
+      else
+	{
+	  fprintf (stderr, "bbprof: unknown option %s\n", argv[i]);
+	  return -1;
+	}
+    }
+
+  blocks = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+  qemu_plugin_register_vcpu_tb_trans_cb (id, vcpu_tb_trans);
+  qemu_plugin_register_atexit_cb (id, plugin_exit, NULL);
+  return 0;
+}
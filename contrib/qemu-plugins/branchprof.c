@@ -0,0 +1,229 @@
+/*
+ * Branch profile for qemu-user, the input of scripts/riscv-autofdo.
+ *
+ * Records how often every translated block is executed and every taken
+ * control transfer between blocks, i.e. what a perf LBR profile samples,
+ * but exact.  When the program exits, out=<path> (default branchprof.out)
+ * gets one line per block and per branch:
+ *
+ *   B <first insn vaddr> <last insn vaddr> <executions>
+ *   E <branch insn vaddr> <target vaddr> <count>
+ *
+ * Falling through into the next block is not a branch and is not listed.
+ *
+ * Usage: qemu-riscv64 -plugin libbranchprof.so,out=<path> <program>
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+#include <qemu-plugin.h>
+
+QEMU_PLUGIN_EXPORT int qemu_plugin_version = QEMU_PLUGIN_VERSION;
+
+/* Most blocks have one or two successors, which are counted in the block
+   itself without taking the lock; the rest go to the edges table.  */
+#define INLINE_SUCCS 2
+
+typedef struct BlockInfo BlockInfo;
+
+typedef struct
+{
+  BlockInfo *to;
+  uint64_t count;
+} Succ;
+
+struct BlockInfo
+{
+  uint64_t vaddr;
+  uint64_t last;
+  uint64_t end;
+  uint64_t count;
+  Succ succs[INLINE_SUCCS];
+};
+
+typedef struct
+{
+  uint64_t from;
+  uint64_t to;
+  uint64_t count;
+} Edge;
+
+static GHashTable *blocks;
+static GHashTable *edges;
+static GMutex lock;
+static char *out_path;
+
+/* qemu-user runs every guest thread on its own host thread.  */
+static __thread BlockInfo *prev_block;
+
+static guint
+edge_hash (gconstpointer p)
+{
+  const Edge *e = p;
+
+  return g_int64_hash (&e->from) ^ g_int64_hash (&e->to);
+}
+
+static gboolean
+edge_equal (gconstpointer a, gconstpointer b)
+{
+  const Edge *x = a, *y = b;
+
+  return x->from == y->from && x->to == y->to;
+}
+
+static void
+count_edge (BlockInfo *from, BlockInfo *to)
+{
+  Edge key = { from->last, to->vaddr, 0 };
+  Edge *e;
+  int i;
+
+  for (i = 0; i < INLINE_SUCCS; i++)
+    {
+      BlockInfo *succ = __atomic_load_n (&from->succs[i].to,
+					 __ATOMIC_ACQUIRE);
+      if (succ == to)
+	{
+	  __atomic_fetch_add (&from->succs[i].count, 1, __ATOMIC_RELAXED);
+	  return;
+	}
+      if (!succ)
+	break;
+    }
+
+  g_mutex_lock (&lock);
+  for (i = 0; i < INLINE_SUCCS; i++)
+    if (!from->succs[i].to)
+      {
+	from->succs[i].count = 1;
+	__atomic_store_n (&from->succs[i].to, to, __ATOMIC_RELEASE);
+	g_mutex_unlock (&lock);
+	return;
+      }
+    else if (from->succs[i].to == to)
+      {
+	__atomic_fetch_add (&from->succs[i].count, 1, __ATOMIC_RELAXED);
+	g_mutex_unlock (&lock);
+	return;
+      }
+
+  e = g_hash_table_lookup (edges, &key);
+  if (!e)
+    {
+      e = g_new0 (Edge, 1);
+      *e = key;
+      g_hash_table_add (edges, e);
+    }
+  e->count++;
+  g_mutex_unlock (&lock);
+}
+
+static void
+vcpu_tb_exec (unsigned int cpu_index, void *udata)
+{
+  BlockInfo *bb = udata;
+  BlockInfo *prev = prev_block;
+
+  __atomic_fetch_add (&bb->count, 1, __ATOMIC_RELAXED);
+  if (prev && prev->end != bb->vaddr)
+    count_edge (prev, bb);
+  prev_block = bb;
+}
+
+static void
+vcpu_tb_trans (qemu_plugin_id_t id, struct qemu_plugin_tb *tb)
+{
+  uint64_t vaddr = qemu_plugin_tb_vaddr (tb);
+  size_t insns = qemu_plugin_tb_n_insns (tb);
+  struct qemu_plugin_insn *last = qemu_plugin_tb_get_insn (tb, insns - 1);
+  /* Identified by start address and length like in bbprof.c, so
+     retranslations share one counter.  */
+  uint64_t key = vaddr ^ ((uint64_t) insns << 48);
+  BlockInfo *bb;
+
+  g_mutex_lock (&lock);
+  bb = g_hash_table_lookup (blocks, (gconstpointer) (uintptr_t) key);
+  if (!bb)
+    {
+      bb = g_new0 (BlockInfo, 1);
+      bb->vaddr = vaddr;
+      bb->last = qemu_plugin_insn_vaddr (last);
+      bb->end = bb->last + qemu_plugin_insn_size (last);
+      g_hash_table_insert (blocks, (gpointer) (uintptr_t) key, bb);
+    }
+  g_mutex_unlock (&lock);
+
+  qemu_plugin_register_vcpu_tb_exec_cb (tb, vcpu_tb_exec,
+					QEMU_PLUGIN_CB_NO_REGS, bb);
+}
+
+static void
+plugin_exit (qemu_plugin_id_t id, void *p)
+{
+  GHashTableIter iter;
+  gpointer value;
+  FILE *out = fopen (out_path, "w");
+  int i;
+
+  if (!out)
+    {
+      perror (out_path);
+      return;
+    }
+
+  g_mutex_lock (&lock);
+  g_hash_table_iter_init (&iter, blocks);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      BlockInfo *bb = value;
+      if (!bb->count)
+	continue;
+      fprintf (out, "B 0x%016" PRIx64 " 0x%016" PRIx64 " %" PRIu64 "\n",
+	       bb->vaddr, bb->last, bb->count);
+      for (i = 0; i < INLINE_SUCCS && bb->succs[i].to; i++)
+	fprintf (out, "E 0x%016" PRIx64 " 0x%016" PRIx64 " %" PRIu64 "\n",
+		 bb->last, bb->succs[i].to->vaddr, bb->succs[i].count);
+    }
+  g_hash_table_iter_init (&iter, edges);
+  while (g_hash_table_iter_next (&iter, &value, NULL))
+    {
+      Edge *e = value;
+      fprintf (out, "E 0x%016" PRIx64 " 0x%016" PRIx64 " %" PRIu64 "\n",
+	       e->from, e->to, e->count);
+    }
+  g_mutex_unlock (&lock);
+  fclose (out);
+}
+
+QEMU_PLUGIN_EXPORT int
+qemu_plugin_install (qemu_plugin_id_t id, const qemu_info_t *info,
+		     int argc, char **argv)
+{
+  int i;
+
+  out_path = g_strdup ("branchprof.out");
+  for (i = 0; i < argc; i++)
+    {
+      if (strncmp (argv[i], "out=", 4) == 0)
+	{
+	  g_free (out_path);
+	  out_path = g_strdup (argv[i] + 4);
+	}
+      else
+	{
+	  fprintf (stderr, "branchprof: unknown option %s\n", argv[i]);
+	  return -1;
+	}
+    }
+
+  blocks = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+  edges = g_hash_table_new_full (edge_hash, edge_equal, g_free, NULL);
+  qemu_plugin_register_vcpu_tb_trans_cb (id, vcpu_tb_trans);
+  qemu_plugin_register_atexit_cb (id, plugin_exit, NULL);
+  return 0;
+}
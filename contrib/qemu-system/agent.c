@@ -0,0 +1,508 @@
+/*
+ * Init process of the qemu-system test guest, see scripts/qemu-system-run.
+ *
+ * Runs as /init of a minimal initramfs.  It mounts the host root file
+ * system shared read-only over virtio-9p (mount tag "host") at /host and
+ * the writable host directories listed on the kernel command line as
+ * riscv.writable=<path>[:<path>...] (mount tags rw0, rw1, ...) over it,
+ * makes every host path valid in the guest through symlinks, except that
+ * /lib, /usr, /etc, /bin and /sbin point into the toolchain sysroot given
+ * as riscv.sysroot=<path>, and then serves run requests from the host on
+ * the virtio-serial port named "agent".
+ *
+ * Both directions use the same framing, a header line followed by a
+ * payload of <length> bytes:
+ *
+ *   <id> <type> <length>\n<payload>
+ *
+ * The host sends type R, whose payload is NUL-terminated strings: the
+ * working directory, the number of environment entries, the entries and
+ * then the argument vector.  The guest answers with O and E frames for
+ * the standard output and error of the program and finally X, whose
+ * payload is the exit status in decimal (128 + signal number if it was
+ * killed).  Requests run concurrently; K kills the process group of a
+ * running request, e.g. after the host side timed out.  Id 0 type H is
+ * sent once when the agent is ready.
+ *
+ * As init, the agent also reaps the orphans of the programs.  Children
+ * are only reaped with WNOHANG when the SIGCHLD signalfd in the poll loop
+ * is readable, and a request finishes once its process has exited and
+ * both of its pipes are closed.
+ */
+
+#define _GNU_SOURCE
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mount.h>
+#include <sys/reboot.h>
+#include <sys/signalfd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define MAX_JOBS 256
+
+struct job
+{
+  unsigned long id;
+  pid_t pid;
+  int fd[2];			/* stdout, stderr; -1 once closed.  */
+  int exited;
+  int status;			/* The X payload once exited.  */
+};
+
+static struct job jobs[MAX_JOBS];
+static int port = -1;
+static int sigchld_fd = -1;
+static sigset_t orig_mask;
+
+static void
+die (const char *what)
+{
+  fprintf (stderr, "agent: %s: %s\n", what, strerror (errno));
+  sync ();
+  reboot (RB_POWER_OFF);
+  _exit (1);
+}
+
+static void
+write_all (int fd, const char *buf, size_t len)
+{
+  while (len > 0)
+    {
+      ssize_t n = write (fd, buf, len);
+      if (n < 0 && errno == EINTR)
+	continue;
+      if (n < 0)
+	die ("write");
+      buf += n;
+      len -= n;
+    }
+}
+
+static void
+send_frame (unsigned long id, char type, const char *buf, size_t len)
+{
+  char header[64];
+  int n = snprintf (header, sizeof header, "%lu %c %zu\n", id, type, len);
+
+  write_all (port, header, n);
+  write_all (port, buf, len);
+}
+
+/* The sysroot the guest runs its programs against and the writable host
+   directories, from /proc/cmdline.  */
+
+static char *sysroot, *writable;
+
+static void
+read_cmdline (void)
+{
+  static char cmdline[4096];
+  char *p;
+  int fd = open ("/proc/cmdline", O_RDONLY);
+  ssize_t n;
+
+  if (fd < 0)
+    die ("/proc/cmdline");
+  n = read (fd, cmdline, sizeof cmdline - 1);
+  close (fd);
+  cmdline[n > 0 ? n : 0] = '\0';
+
+  for (p = strtok (cmdline, " \n"); p; p = strtok (NULL, " \n"))
+    if (strncmp (p, "riscv.sysroot=", 14) == 0)
+      sysroot = p + 14;
+    else if (strncmp (p, "riscv.writable=", 15) == 0)
+      writable = p + 15;
+}
+
+/* Top-level directories taken from the sysroot instead of the host.  */
+static const char *const sysroot_dirs[] = { "lib", "lib32", "lib64", "usr",
+					    "etc", "bin", "sbin", NULL };
+
+static int
+from_sysroot (const char *name)
+{
+  int i;
+
+  for (i = 0; sysroot_dirs[i]; i++)
+    if (strcmp (name, sysroot_dirs[i]) == 0)
+      return 1;
+  return 0;
+}
+
+static void
+setup_root (void)
+{
+  struct dirent *d;
+  char target[4096];
+  char *path, *save;
+  DIR *dir;
+  int i;
+
+  mkdir ("/proc", 0755);
+  mkdir ("/sys", 0755);
+  mkdir ("/dev", 0755);
+  mkdir ("/host", 0755);
+  if (mount ("proc", "/proc", "proc", 0, NULL) != 0
+      || mount ("sysfs", "/sys", "sysfs", 0, NULL) != 0
+      || mount ("devtmpfs", "/dev", "devtmpfs", 0, NULL) != 0)
+    die ("mount");
+  if (mount ("host", "/host", "9p", MS_RDONLY,
+	     "trans=virtio,version=9p2000.L,msize=262144,cache=none") != 0)
+    die ("mount host");
+
+  read_cmdline ();
+  if (!sysroot)
+    {
+      errno = EINVAL;
+      die ("riscv.sysroot");
+    }
+
+  /* The host passes no writable directory that is inside another.  */
+  i = 0;
+  for (path = writable ? strtok_r (writable, ":", &save) : NULL; path;
+       path = strtok_r (NULL, ":", &save))
+    {
+      char tag[16];
+
+      snprintf (tag, sizeof tag, "rw%d", i++);
+      snprintf (target, sizeof target, "/host%s", path);
+      if (mount (tag, target, "9p", 0,
+		 "trans=virtio,version=9p2000.L,msize=262144,cache=none")
+	  != 0)
+	die (target);
+    }
+
+  dir = opendir ("/host");
+  if (!dir)
+    die ("/host");
+  while ((d = readdir (dir)) != NULL)
+    {
+      struct stat st;
+
+      if (d->d_name[0] == '.' || from_sysroot (d->d_name))
+	continue;
+      /* Keep the guest's own /proc, /sys, /dev and /host.  */
+      snprintf (target, sizeof target, "/%s", d->d_name);
+      if (lstat (target, &st) == 0)
+	continue;
+      snprintf (target, sizeof target, "/host/%s", d->d_name);
+      if (symlink (target, target + 5) != 0)
+	die (target + 5);
+    }
+  closedir (dir);
+
+  for (i = 0; sysroot_dirs[i]; i++)
+    {
+      char link[64];
+      struct stat st;
+
+      snprintf (target, sizeof target, "/host%s/%s", sysroot,
+		sysroot_dirs[i]);
+      snprintf (link, sizeof link, "/%s", sysroot_dirs[i]);
+      if (stat (target, &st) == 0 && symlink (target, link) != 0)
+	die (link);
+    }
+
+  mkdir ("/tmp", 01777);
+}
+
+static int
+open_port (void)
+{
+  struct dirent *d;
+  DIR *dir = opendir ("/sys/class/virtio-ports");
+
+  if (!dir)
+    die ("/sys/class/virtio-ports");
+  while ((d = readdir (dir)) != NULL)
+    {
+      char path[512], name[64];
+      ssize_t n;
+      int fd;
+
+      snprintf (path, sizeof path, "/sys/class/virtio-ports/%s/name",
+		d->d_name);
+      fd = open (path, O_RDONLY);
+      if (fd < 0)
+	continue;
+      n = read (fd, name, sizeof name - 1);
+      close (fd);
+      name[n > 0 ? n : 0] = '\0';
+      if (strcmp (name, "agent\n") != 0 && strcmp (name, "agent") != 0)
+	continue;
+      closedir (dir);
+      snprintf (path, sizeof path, "/dev/%s", d->d_name);
+      fd = open (path, O_RDWR | O_CLOEXEC);
+      if (fd < 0)
+	die (path);
+      return fd;
+    }
+  errno = ENOENT;
+  die ("virtio port agent");
+  return -1;
+}
+
+/* Start the request in PAYLOAD, LEN bytes, as job ID.  */
+
+static void
+start_job (unsigned long id, char *payload, size_t len)
+{
+  char *fields[4096], *p = payload, *end = payload + len;
+  int nfields = 0, nenv, i, out[2], err[2];
+  struct job *job = NULL;
+  pid_t pid;
+
+  while (p < end && nfields < 4095)
+    {
+      fields[nfields++] = p;
+      p += strlen (p) + 1;
+    }
+  fields[nfields] = NULL;
+
+  for (i = 0; i < MAX_JOBS; i++)
+    if (jobs[i].pid == 0)
+      {
+	job = &jobs[i];
+	break;
+      }
+
+  nenv = nfields >= 2 ? atoi (fields[1]) : -1;
+  if (!job || nenv < 0 || 2 + nenv >= nfields)
+    {
+      static const char msg[] = "agent: bad request or too many jobs\n";
+      send_frame (id, 'E', msg, sizeof msg - 1);
+      send_frame (id, 'X', "127", 3);
+      return;
+    }
+
+  if (pipe2 (out, O_CLOEXEC) != 0 || pipe2 (err, O_CLOEXEC) != 0)
+    die ("pipe");
+  pid = fork ();
+  if (pid < 0)
+    die ("fork");
+  if (pid == 0)
+    {
+      char **env = calloc (nenv + 1, sizeof *env);
+      char **argv = &fields[2 + nenv];
+
+      memcpy (env, &fields[2], nenv * sizeof *env);
+      sigprocmask (SIG_SETMASK, &orig_mask, NULL);
+      setsid ();
+      dup2 (out[1], 1);
+      dup2 (err[1], 2);
+      i = open ("/dev/null", O_RDONLY);
+      dup2 (i, 0);
+      if (chdir (fields[0]) != 0)
+	{
+	  fprintf (stderr, "agent: chdir %s: %s\n", fields[0],
+		   strerror (errno));
+	  _exit (127);
+	}
+      execve (argv[0], argv, env);
+      fprintf (stderr, "agent: %s: %s\n", argv[0], strerror (errno));
+      _exit (127);
+    }
+
+  close (out[1]);
+  close (err[1]);
+  job->id = id;
+  job->pid = pid;
+  job->fd[0] = out[0];
+  job->fd[1] = err[0];
+  job->exited = 0;
+}
+
+static void
+kill_job (unsigned long id)
+{
+  int i;
+
+  for (i = 0; i < MAX_JOBS; i++)
+    if (jobs[i].pid != 0 && jobs[i].id == id)
+      kill (-jobs[i].pid, SIGKILL);
+}
+
+/* Reap every child that has exited, without blocking, and record the
+   status of the jobs among them.  */
+
+static void
+reap_children (void)
+{
+  struct signalfd_siginfo info;
+  int status, i;
+  pid_t pid;
+
+  while (read (sigchld_fd, &info, sizeof info) > 0)
+    ;
+  while ((pid = waitpid (-1, &status, WNOHANG)) > 0)
+    for (i = 0; i < MAX_JOBS; i++)
+      if (jobs[i].pid == pid && !jobs[i].exited)
+	{
+	  jobs[i].exited = 1;
+	  if (WIFSIGNALED (status))
+	    jobs[i].status = 128 + WTERMSIG (status);
+	  else
+	    jobs[i].status = WEXITSTATUS (status);
+	}
+  if (pid < 0 && errno != ECHILD && errno != EINTR)
+    die ("waitpid");
+}
+
+static void
+finish_job (struct job *job)
+{
+  char buf[16];
+  int n;
+
+  if (!job->exited || job->fd[0] >= 0 || job->fd[1] >= 0)
+    return;
+  n = snprintf (buf, sizeof buf, "%d", job->status);
+  send_frame (job->id, 'X', buf, n);
+  job->pid = 0;
+}
+
+/* Consume the complete frames at the start of BUF, LEN bytes, and return
+   the number of bytes used.  */
+
+static size_t
+handle_input (char *buf, size_t len)
+{
+  size_t used = 0;
+
+  for (;;)
+    {
+      char *nl = memchr (buf + used, '\n', len - used);
+      unsigned long id;
+      size_t size;
+      char type;
+
+      if (!nl)
+	return used;
+      *nl = '\0';
+      if (sscanf (buf + used, "%lu %c %zu", &id, &type, &size) != 3)
+	{
+	  errno = EPROTO;
+	  die ("request header");
+	}
+      if ((size_t) (buf + len - (nl + 1)) < size)
+	{
+	  *nl = '\n';
+	  return used;
+	}
+      if (type == 'R')
+	start_job (id, nl + 1, size);
+      else if (type == 'K')
+	kill_job (id);
+      used = nl + 1 + size - buf;
+    }
+}
+
+int
+main (void)
+{
+  static char in[1 << 20];
+  size_t in_len = 0;
+
+  sigset_t mask;
+
+  setup_root ();
+  port = open_port ();
+  signal (SIGPIPE, SIG_IGN);
+  sigemptyset (&mask);
+  sigaddset (&mask, SIGCHLD);
+  if (sigprocmask (SIG_BLOCK, &mask, &orig_mask) != 0)
+    die ("sigprocmask");
+  sigchld_fd = signalfd (-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+  if (sigchld_fd < 0)
+    die ("signalfd");
+  send_frame (0, 'H', "", 0);
+
+  for (;;)
+    {
+      struct pollfd fds[2 + 2 * MAX_JOBS];
+      struct job *owner[2 + 2 * MAX_JOBS];
+      int which[2 + 2 * MAX_JOBS];
+      int nfds = 2, i;
+
+      fds[0].fd = port;
+      fds[0].events = POLLIN;
+      fds[1].fd = sigchld_fd;
+      fds[1].events = POLLIN;
+      for (i = 0; i < MAX_JOBS; i++)
+	for (int j = 0; j < 2; j++)
+	  if (jobs[i].pid != 0 && jobs[i].fd[j] >= 0)
+	    {
+	      fds[nfds].fd = jobs[i].fd[j];
+	      fds[nfds].events = POLLIN;
+	      owner[nfds] = &jobs[i];
+	      which[nfds++] = j;
+	    }
+
+      if (poll (fds, nfds, -1) < 0)
+	{
+	  if (errno == EINTR)
+	    continue;
+	  die ("poll");
+	}
+
+      for (i = 2; i < nfds; i++)
+	{
+	  struct job *job = owner[i];
+	  char buf[65536];
+	  ssize_t n;
+
+	  if (!fds[i].revents)
+	    continue;
+	  n = read (fds[i].fd, buf, sizeof buf);
+	  if (n > 0)
+	    {
+	      send_frame (job->id, which[i] ? 'E' : 'O', buf, n);
+	      continue;
+	    }
+	  if (n < 0 && errno == EINTR)
+	    continue;
+	  close (job->fd[which[i]]);
+	  job->fd[which[i]] = -1;
+	  finish_job (job);
+	}
+
+      if (fds[1].revents)
+	{
+	  reap_children ();
+	  for (i = 0; i < MAX_JOBS; i++)
+	    if (jobs[i].pid != 0)
+	      finish_job (&jobs[i]);
+	}
+
+      if (fds[0].revents)
+	{
+	  ssize_t n = read (port, in + in_len, sizeof in - in_len);
+	  size_t used;
+
+	  /* Nothing is connected to the host side of the port.  */
+	  if (n <= 0)
+	    {
+	      if (n == 0)
+		usleep (100000);
+	      continue;
+	    }
+	  in_len += n;
+	  used = handle_input (in, in_len);
+	  memmove (in, in + used, in_len - used);
+	  in_len -= used;
+	  if (in_len == sizeof in)
+	    {
+	      errno = E2BIG;
+	      die ("request");
+	    }
+	}
+    }
+}
@@ -0,0 +1,163 @@
+// See LICENSE for license details.
+
+//**************************************************************************
+// Atomics code generation benchmark
+//--------------------------------------------------------------------------
+//
+// Usage: atomics <kernel> <iterations> [threads], or no arguments to list
+// the kernels.  Every thread runs <iterations> operations on the same
+// shared variables, so with more than one thread the CAS loops retry and
+// the LR/SC sequences fail under contention.  Threads are only available
+// on Linux targets.
+//
+// On rv32 the 64-bit atomics are always libatomic calls, so their kernels
+// are only built when the driver links libatomic (-DUSE_LIBATOMIC); newlib
+// has no libatomic.
+//
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef __linux__
+#include <pthread.h>
+#endif
+
+#define ORDER __ATOMIC_SEQ_CST
+
+#if __riscv_xlen == 64 || defined USE_LIBATOMIC
+#define HAVE_ATOMIC_64 1
+#endif
+
+static uint8_t v8;
+static uint16_t v16;
+static uint32_t v32;
+#ifdef HAVE_ATOMIC_64
+static uint64_t v64;
+#endif
+
+#define DEFINE_FETCH_ADD(bits) \
+  static void \
+  fetch_add_##bits (unsigned long n) \
+  { \
+    for (unsigned long i = 0; i < n; i++) \
+      __atomic_fetch_add (&v##bits, 1, ORDER); \
+  }
+
+#define DEFINE_EXCHANGE(bits) \
+  static void \
+  exchange_##bits (unsigned long n) \
+  { \
+    for (unsigned long i = 0; i < n; i++) \
+      __atomic_exchange_n (&v##bits, i, ORDER); \
+  }
+
+/* A read-modify-write that has no AMO equivalent, so it has to be done
+   with a compare-and-swap loop.  */
+#define DEFINE_CAS_LOOP(bits) \
+  static void \
+  cas_loop_##bits (unsigned long n) \
+  { \
+    for (unsigned long i = 0; i < n; i++) \
+      { \
+	uint##bits##_t old = __atomic_load_n (&v##bits, __ATOMIC_RELAXED); \
+	uint##bits##_t new; \
+	do \
+	  new = old * 3 + 1; \
+	while (!__atomic_compare_exchange_n (&v##bits, &old, new, 1, ORDER, \
+					     __ATOMIC_RELAXED)); \
+      } \
+  }
+
+DEFINE_FETCH_ADD (8)
+DEFINE_FETCH_ADD (16)
+DEFINE_FETCH_ADD (32)
+DEFINE_EXCHANGE (8)
+DEFINE_EXCHANGE (16)
+DEFINE_EXCHANGE (32)
+DEFINE_CAS_LOOP (8)
+DEFINE_CAS_LOOP (16)
+DEFINE_CAS_LOOP (32)
+#ifdef HAVE_ATOMIC_64
+DEFINE_FETCH_ADD (64)
+DEFINE_EXCHANGE (64)
+DEFINE_CAS_LOOP (64)
+#endif
+
+static const struct
+{
+  const char *name;
+  void (*run) (unsigned long);
+} kernels[] = {
+  { "fetch_add_8", fetch_add_8 }, { "fetch_add_16", fetch_add_16 },
+  { "fetch_add_32", fetch_add_32 },
+  { "exchange_8", exchange_8 }, { "exchange_16", exchange_16 },
+  { "exchange_32", exchange_32 },
+  { "cas_loop_8", cas_loop_8 }, { "cas_loop_16", cas_loop_16 },
+  { "cas_loop_32", cas_loop_32 },
+#ifdef HAVE_ATOMIC_64
+  { "fetch_add_64", fetch_add_64 }, { "exchange_64", exchange_64 },
+  { "cas_loop_64", cas_loop_64 },
+#endif
+};
+
+#define KERNEL_COUNT (sizeof (kernels) / sizeof (kernels[0]))
+
+static void (*run_kernel) (unsigned long);
+static unsigned long iterations;
+
+static void *
+thread_main (void *arg)
+{
+  run_kernel (iterations);
+  return arg;
+}
+
+int
+main (int argc, char **argv)
+{
+  unsigned long threads = 1;
+  size_t i;
+
+  if (argc < 3)
+    {
+      for (i = 0; i < KERNEL_COUNT; i++)
+	printf ("%s\n", kernels[i].name);
+      return 0;
+    }
+
+  for (i = 0; i < KERNEL_COUNT; i++)
+    if (strcmp (kernels[i].name, argv[1]) == 0)
+      break;
+  if (i == KERNEL_COUNT)
+    {
+      fprintf (stderr, "unknown kernel %s\n", argv[1]);
+      return 1;
+    }
+  run_kernel = kernels[i].run;
+  iterations = strtoul (argv[2], NULL, 0);
+  if (argc > 3)
+    threads = strtoul (argv[3], NULL, 0);
+
+#ifdef __linux__
+  if (threads > 1)
+    {
+      pthread_t *tids = calloc (threads, sizeof (pthread_t));
+      for (i = 0; i < threads; i++)
+	pthread_create (&tids[i], NULL, thread_main, NULL);
+      for (i = 0; i < threads; i++)
+	pthread_join (tids[i], NULL);
+      free (tids);
+      return 0;
+    }
+#else
+  if (threads > 1)
+    {
+      fprintf (stderr, "threads are not supported on this target\n");
+      return 1;
+    }
+#endif
+
+  thread_main (NULL);
+  return 0;
+}
@@ -0,0 +1,301 @@
+// See LICENSE for license details.
+
+//**************************************************************************
+// Bit-manipulation kernels
+//--------------------------------------------------------------------------
+//
+// Usage: bitmanip-kernels <kernel> <iterations>, or no arguments to list
+// the kernels.  Every kernel prints a checksum that must not depend on
+// -march.
+//
+// Apart from crc32_clmul, the kernels are plain C written the way the
+// Zba/Zbb/Zbc/Zbs patterns in GCC expect to find them: shifted and
+// zero-extended index arithmetic (sh[123]add[.uw], add.uw), population
+// count and leading/trailing zero counts (cpop, clz, ctz), rotates and
+// inverted logic (ror, andn, orn, xnor), min/max, byte swaps (rev8),
+// single-bit operations (bset, bclr, binv, bext) and a bitwise CRC loop,
+// which GCC may turn into a carry-less multiplication with Zbc.
+// crc32_clmul is a Barrett reduction that uses clmul/clmulr directly on
+// RV64 with Zbc and a C emulation otherwise.
+//
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define N 4096
+
+static uint64_t words[N];
+static uint32_t idx[N];
+static uint64_t a64[N + 1];
+static uint32_t a32[N + 1];
+static uint16_t a16[N + 1];
+static uint8_t bytes[8 * N];
+
+static uint32_t
+crc32_update (uint32_t crc, const uint8_t *p, size_t len)
+{
+  for (size_t i = 0; i < len; i++)
+    {
+      crc ^= p[i];
+      for (int b = 0; b < 8; b++)
+	crc = (crc >> 1) ^ (0xedb88320 & -(crc & 1));
+    }
+  return crc;
+}
+
+static uint64_t
+crc32 (unsigned long iters)
+{
+  uint32_t crc = 0xffffffff;
+
+  for (unsigned long it = 0; it < iters; it++)
+    crc = crc32_update (crc, bytes, sizeof bytes);
+  return crc ^ 0xffffffff;
+}
+
+#if defined (__riscv_zbc) && __riscv_xlen == 64
+static inline uint64_t
+clmul (uint64_t rs1, uint64_t rs2)
+{
+  uint64_t rd;
+  asm ("clmul %0, %1, %2" : "=r"(rd) : "r"(rs1), "r"(rs2));
+  return rd;
+}
+
+static inline uint64_t
+clmulr (uint64_t rs1, uint64_t rs2)
+{
+  uint64_t rd;
+  asm ("clmulr %0, %1, %2" : "=r"(rd) : "r"(rs1), "r"(rs2));
+  return rd;
+}
+#else
+static uint64_t
+clmul (uint64_t rs1, uint64_t rs2)
+{
+  uint64_t rd = 0;
+  for (int i = 0; i < 64; i++)
+    if ((rs2 >> i) & 1)
+      rd ^= rs1 << i;
+  return rd;
+}
+
+static uint64_t
+clmulr (uint64_t rs1, uint64_t rs2)
+{
+  uint64_t rd = 0;
+  for (int i = 0; i < 64; i++)
+    if ((rs2 >> i) & 1)
+      rd ^= rs1 >> (63 - i);
+  return rd;
+}
+#endif
+
+// Eight bytes at a time: with S the CRC xor the next eight bytes, the new
+// CRC is S * x^32 mod P in the bit-reflected domain, computed with the
+// reflected quotient x^96 / P as in Linux's RISC-V crc32.
+static uint64_t
+crc32_clmul (unsigned long iters)
+{
+  const uint64_t poly = 0xedb88320ull << 32;
+  const uint64_t quotient = 0x5a72d812fb808b20ull;
+  uint32_t crc = 0xffffffff;
+
+  for (unsigned long it = 0; it < iters; it++)
+    for (size_t i = 0; i < sizeof bytes; i += 8)
+      {
+	uint64_t s, t;
+
+	memcpy (&s, bytes + i, 8);
+	s ^= crc;
+	t = (clmul (s, quotient) << 1) ^ s;
+	crc = clmulr (t, poly) >> 32;
+      }
+  return crc ^ 0xffffffff;
+}
+
+// Scan a bitset: count the members and sum their positions.
+static uint64_t
+bitset_scan (unsigned long iters)
+{
+  uint64_t sum = 0;
+
+  for (unsigned long it = 0; it < iters; it++)
+    for (size_t i = 0; i < N; i++)
+      {
+	uint64_t w = words[i] ^ it;
+
+	sum += __builtin_popcountll (w);
+	while (w)
+	  {
+	    sum += 64 * i + __builtin_ctzll (w);
+	    w &= w - 1;
+	  }
+      }
+  return sum;
+}
+
+// Integer logarithms and normalization, as in allocators and soft-float.
+static uint64_t
+clz_log2 (unsigned long iters)
+{
+  uint64_t sum = 0;
+
+  for (unsigned long it = 0; it < iters; it++)
+    for (size_t i = 0; i < N; i++)
+      {
+	uint64_t w = words[i] | 1;
+	int lz = __builtin_clzll (w);
+	uint32_t v = (uint32_t) w | 1;
+
+	sum += (63 - lz) + ((w << lz) >> 52) + __builtin_clz (v)
+	       + (v > it ? v : it) - (v < it ? v : it);
+      }
+  return sum;
+}
+
+static inline uint64_t
+rotl64 (uint64_t x, int n)
+{
+  return (x << n) | (x >> (64 - n));
+}
+
+static inline uint32_t
+rotr32 (uint32_t x, int n)
+{
+  return (x >> n) | (x << (32 - n));
+}
+
+// Hash mixing, after the xxHash and MurmurHash3 finalizers.
+static uint64_t
+hash_mix (unsigned long iters)
+{
+  uint64_t h = 0x9e3779b97f4a7c15ull;
+  uint32_t g = 0x85ebca6b;
+
+  for (unsigned long it = 0; it < iters; it++)
+    for (size_t i = 0; i < N; i++)
+      {
+	h ^= rotl64 (words[i] * 0xc2b2ae3d27d4eb4full, 31)
+	     * 0x9e3779b185ebca87ull;
+	h = rotl64 (h, 27) * 0x9e3779b185ebca87ull + 0x85ebca77c2b2ae63ull;
+	h ^= (h & ~words[i]) | (~h & (uint64_t) i);
+	g = rotr32 (g ^ (uint32_t) h, 13) * 5 + 0xe6546b64;
+	g ^= ~(g ^ (uint32_t) words[i]);
+      }
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdull;
+  h ^= h >> 33;
+  return h ^ g;
+}
+
+// Gathers through 32-bit unsigned indices into arrays of 2, 4 and 8 byte
+// elements.
+static uint64_t
+addr_gen (unsigned long iters)
+{
+  uint64_t sum = 0;
+
+  for (unsigned long it = 0; it < iters; it++)
+    for (uint32_t i = 0; i < N; i++)
+      {
+	uint32_t j = idx[i];
+
+	sum += a64[j] + a32[j + 1] + a16[j] + a64[i + 1];
+	a32[j] += (uint32_t) it;
+      }
+  return sum;
+}
+
+// Endianness conversion of network/storage data.
+static uint64_t
+byte_swap (unsigned long iters)
+{
+  uint64_t sum = 0;
+
+  for (unsigned long it = 0; it < iters; it++)
+    for (size_t i = 0; i < N; i++)
+      {
+	uint64_t w = __builtin_bswap64 (words[i]);
+
+	words[i] = w ^ it;
+	sum += w + __builtin_bswap32 ((uint32_t) w)
+	       + __builtin_bswap16 ((uint16_t) (w >> 16));
+      }
+  return sum;
+}
+
+// Single-bit set, clear, invert and extract on a bitmap.
+static uint64_t
+single_bit (unsigned long iters)
+{
+  uint64_t sum = 0;
+
+  for (unsigned long it = 0; it < iters; it++)
+    for (size_t i = 0; i < N; i++)
+      {
+	unsigned pos = (unsigned) (words[i] >> 7) % (64 * N);
+	unsigned bit = pos % 64;
+
+	words[pos / 64] |= 1ull << bit;
+	words[i] &= ~(1ull << ((bit + 3) % 64));
+	words[(i + 1) % N] ^= 1ull << (i % 64);
+	sum += (words[i] >> bit) & 1;
+      }
+  return sum ^ words[0];
+}
+
+static const struct
+{
+  const char *name;
+  uint64_t (*run) (unsigned long);
+} kernels[] = {
+  { "crc32", crc32 },
+  { "crc32_clmul", crc32_clmul },
+  { "bitset_scan", bitset_scan },
+  { "clz_log2", clz_log2 },
+  { "hash_mix", hash_mix },
+  { "addr_gen", addr_gen },
+  { "byte_swap", byte_swap },
+  { "single_bit", single_bit },
+};
+
+#define KERNEL_COUNT (sizeof (kernels) / sizeof (kernels[0]))
+
+int
+main (int argc, char **argv)
+{
+  size_t i;
+
+  if (argc < 3)
+    {
+      for (i = 0; i < KERNEL_COUNT; i++)
+	printf ("%s\n", kernels[i].name);
+      return 0;
+    }
+
+  for (i = 0; i < N; i++)
+    {
+      words[i] = (uint64_t) i * 0x9e3779b97f4a7c15ull;
+      words[i] &= words[i] >> (i % 13);
+      idx[i] = (uint32_t) ((i * 97) % N);
+      a64[i] = i * 3;
+      a32[i] = (uint32_t) (i ^ 0x5a5a);
+      a16[i] = (uint16_t) (i * 7);
+    }
+  for (i = 0; i < sizeof bytes; i++)
+    bytes[i] = (uint8_t) (i * 131 + (i >> 8));
+
+  for (i = 0; i < KERNEL_COUNT; i++)
+    if (strcmp (kernels[i].name, argv[1]) == 0)
+      {
+	uint64_t sum = kernels[i].run (strtoul (argv[2], NULL, 0));
+	printf ("%s %016llx\n", argv[1], (unsigned long long) sum);
+	return 0;
+      }
+
+  fprintf (stderr, "unknown kernel %s\n", argv[1]);
+  return 1;
+}
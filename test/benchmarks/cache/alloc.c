@@ -0,0 +1,112 @@
+// See LICENSE for license details.
+
+//**************************************************************************
+// Allocator layout benchmark
+//--------------------------------------------------------------------------
+//
+// Usage: alloc <nodes> <passes>.  Builds a binary search tree out of
+// individually allocated nodes of mixed sizes, frees every third node and
+// re-inserts it, then walks the tree <passes> times.  The walk touches
+// the nodes in key order, not allocation order, so its cache behaviour
+// depends on where the allocator placed them.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+
+struct node
+{
+  struct node *left, *right;
+  unsigned long key;
+  char payload[];
+};
+
+static struct node *
+insert (struct node *root, struct node *n)
+{
+  struct node **link = &root;
+
+  while (*link)
+    link = n->key < (*link)->key ? &(*link)->left : &(*link)->right;
+  *link = n;
+  return root;
+}
+
+static struct node *
+new_node (unsigned long key)
+{
+  /* 16 to 112 bytes of payload, so the allocator sees several size
+     classes.  */
+  size_t payload = 16 + (key % 7) * 16;
+  struct node *n = malloc (sizeof (*n) + payload);
+
+  if (!n)
+    {
+      fprintf (stderr, "out of memory\n");
+      exit (1);
+    }
+  n->left = n->right = NULL;
+  n->key = key;
+  n->payload[0] = (char) key;
+  return n;
+}
+
+static unsigned long
+walk (const struct node *n)
+{
+  unsigned long sum = 0;
+
+  while (n)
+    {
+      sum += walk (n->left) + n->key + n->payload[0];
+      n = n->right;
+    }
+  return sum;
+}
+
+static struct node *
+remove_every_third (struct node *n, struct node ***freed)
+{
+  if (!n)
+    return NULL;
+  n->left = remove_every_third (n->left, freed);
+  n->right = remove_every_third (n->right, freed);
+  if (n->key % 3 == 0 && !n->left && !n->right)
+    {
+      *(*freed)++ = n;
+      return NULL;
+    }
+  return n;
+}
+
+int
+main (int argc, char **argv)
+{
+  unsigned long nodes = argc > 1 ? strtoul (argv[1], NULL, 0) : 4096;
+  unsigned long passes = argc > 2 ? strtoul (argv[2], NULL, 0) : 16;
+  struct node **removed = malloc (nodes * sizeof (*removed));
+  struct node **end = removed, **p;
+  struct node *root = NULL;
+  unsigned long long state = 1;
+  unsigned long sum = 0, i;
+
+  for (i = 0; i < nodes; i++)
+    {
+      state = state * 6364136223846793005ull + 1442695040888963407ull;
+      root = insert (root, new_node (state >> 33));
+    }
+
+  root = remove_every_third (root, &end);
+  for (p = removed; p < end; p++)
+    {
+      unsigned long key = (*p)->key + 1;
+      free (*p);
+      root = insert (root, new_node (key));
+    }
+
+  for (i = 0; i < passes; i++)
+    sum += walk (root);
+
+  printf ("%lu\n", sum);
+  return 0;
+}
@@ -0,0 +1,112 @@
+// See LICENSE for license details.
+
+//**************************************************************************
+// Counter based benchmark harness
+//--------------------------------------------------------------------------
+//
+// Reads the cycle, instret and time counters around a timed region and
+// prints one result line per region:
+//
+//   BENCH: <name> iterations=<n> cycles=<n> instret=<n> time=<n>
+//
+// which test/benchmarks/common/benchlib.py parses with harness_results().
+// The counters are read from U-mode, so this works under the proxy kernel
+// (which enables them through mcounteren), on qemu-user and spike.  Note
+// that qemu-user returns host timestamp ticks for cycle and instret; use
+// the QEMU insn plugin when the guest instruction count matters there.
+// Define BENCH_NO_TIME on targets where reading the time CSR traps.
+//
+// Typical use:
+//
+//   bench_region_t r;
+//   bench_begin (&r);
+//   ... timed code ...
+//   bench_end (&r);
+//   bench_report ("name", &r, iterations);
+//
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+// The counters are read with a raw CSRRS encoding so the header does not
+// depend on Zicsr/Zicntr being part of -march.  The immediate is the CSR
+// number sign-extended from 12 bits.
+#define BENCH_READ_CSR(csr) ({ unsigned long __tmp; \
+  asm volatile (".insn i 0x73, 2, %0, x0, %1" \
+		: "=r"(__tmp) : "i"((csr) - 0x1000)); \
+  __tmp; })
+
+#define BENCH_CSR_CYCLE    0xc00
+#define BENCH_CSR_TIME     0xc01
+#define BENCH_CSR_INSTRET  0xc02
+#define BENCH_CSR_CYCLEH   0xc80
+#define BENCH_CSR_TIMEH    0xc81
+#define BENCH_CSR_INSTRETH 0xc82
+
+#if __riscv_xlen == 32
+// Re-read the high half until it is stable so a carry between the two
+// reads cannot produce a value that is off by 2^32.
+#define BENCH_READ_COUNTER(lo, hi) ({ uint32_t __hi, __lo; \
+  do \
+    { \
+      __hi = BENCH_READ_CSR (hi); \
+      __lo = BENCH_READ_CSR (lo); \
+    } \
+  while (__hi != BENCH_READ_CSR (hi)); \
+  ((uint64_t) __hi << 32) | __lo; })
+#else
+#define BENCH_READ_COUNTER(lo, hi) ((uint64_t) BENCH_READ_CSR (lo))
+#endif
+
+typedef struct
+{
+  uint64_t cycle;
+  uint64_t instret;
+  uint64_t time;
+} bench_counters_t;
+
+typedef struct
+{
+  bench_counters_t begin;
+  bench_counters_t end;
+} bench_region_t;
+
+static inline void
+bench_read_counters (bench_counters_t *c)
+{
+  c->cycle = BENCH_READ_COUNTER (BENCH_CSR_CYCLE, BENCH_CSR_CYCLEH);
+  c->instret = BENCH_READ_COUNTER (BENCH_CSR_INSTRET, BENCH_CSR_INSTRETH);
+#ifndef BENCH_NO_TIME
+  c->time = BENCH_READ_COUNTER (BENCH_CSR_TIME, BENCH_CSR_TIMEH);
+#else
+  c->time = 0;
+#endif
+}
+
+static inline void
+bench_begin (bench_region_t *r)
+{
+  bench_read_counters (&r->begin);
+}
+
+static inline void
+bench_end (bench_region_t *r)
+{
+  bench_read_counters (&r->end);
+}
+
+static inline void
+bench_report (const char *name, const bench_region_t *r,
+	      unsigned long iterations)
+{
+  printf ("BENCH: %s iterations=%lu cycles=%llu instret=%llu time=%llu\n",
+	  name, iterations,
+	  (unsigned long long) (r->end.cycle - r->begin.cycle),
+	  (unsigned long long) (r->end.instret - r->begin.instret),
+	  (unsigned long long) (r->end.time - r->begin.time));
+}
+
+#endif
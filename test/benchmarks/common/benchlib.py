@@ -0,0 +1,269 @@
+#!/usr/bin/env python3
+
+# Helpers shared by the benchmark drivers under test/benchmarks.
+#
+# Every driver writes its results as one line per measurement:
+#
+#   PASS: <benchmark> <config>... <metric>=<value> <metric>=<value> ...
+#
+# Words without '=' identify the measurement, words with '=' are metrics.
+# A line starting with anything other than "PASS:" makes the corresponding
+# report target fail, just like the dhrystone check.
+
+import functools
+import os
+import re
+import subprocess
+import sys
+import tempfile
+import time
+
+# Metrics where a larger value is better; all other metrics are
+# lower-is-better.
+HIGHER_IS_BETTER = {"speedup", "pch_used", "compressed"}
+
+# Metrics that are derived from others and have no better direction, so
+# history does not look for trends in them.
+UNTRENDED = {"breakeven"}
+
+
+def run_measured(cmd, env=None, cwd=None, stdout=subprocess.DEVNULL,
+                 stderr=subprocess.PIPE):
+    """ Run cmd and return (returncode, wall seconds, peak RSS in KiB,
+        captured stderr).  The peak RSS covers the whole process tree that
+        was waited for, so it includes cc1/ld when invoked through the
+        gcc driver.
+    """
+    start = time.monotonic()
+    proc = subprocess.Popen(cmd, env=env, cwd=cwd, stdout=stdout,
+                            stderr=stderr)
+    err = b""
+    if stderr == subprocess.PIPE:
+        err = proc.stderr.read()
+        proc.stderr.close()
+    _, status, rusage = os.wait4(proc.pid, 0)
+    wall = time.monotonic() - start
+    if os.WIFEXITED(status):
+        proc.returncode = os.WEXITSTATUS(status)
+    else:
+        proc.returncode = -os.WTERMSIG(status)
+    return proc.returncode, wall, rusage.ru_maxrss, \
+        err.decode("utf-8", "replace")
+
+
+def format_result(status, ident, metrics):
+    words = ["%s:" % status] + list(ident)
+    for key, val in metrics.items():
+        if isinstance(val, float):
+            val = "%.4f" % val
+        words.append("%s=%s" % (key, val))
+    return " ".join(words)
+
+
+def parse_result_line(line):
+    """ Return (status, ident tuple, metrics dict) or None. """
+    words = line.split()
+    if not words or not words[0].endswith(":"):
+        return None
+    status = words[0][:-1]
+    ident = []
+    metrics = {}
+    for word in words[1:]:
+        if "=" in word:
+            key, val = word.split("=", 1)
+            try:
+                metrics[key] = float(val)
+            except ValueError:
+                metrics[key] = val
+        else:
+            ident.append(word)
+    return status, tuple(ident), metrics
+
+
+def read_results(path):
+    results = {}
+    if not path or not os.path.exists(path):
+        return results
+    with open(path) as f:
+        for line in f:
+            parsed = parse_result_line(line)
+            if parsed:
+                results[parsed[1]] = parsed[2]
+    return results
+
+
+def harness_results(text):
+    """ Collect the "BENCH:" lines printed by bench.h into a dict mapping
+        the region name to its counters.
+    """
+    results = {}
+    for line in text.splitlines():
+        parsed = parse_result_line(line)
+        if parsed and parsed[0] == "BENCH" and parsed[1]:
+            results[" ".join(parsed[1])] = parsed[2]
+    return results
+
+
+def regressions(baseline, metrics, keys, tolerance, floors={}):
+    """ Return the list of (key, baseline, current) for every metric in
+        keys that grew by more than tolerance percent.  floors gives the
+        smallest absolute change per metric that is not considered noise.
+    """
+    worse = []
+    for key in keys:
+        old = baseline.get(key)
+        new = metrics.get(key)
+        if not isinstance(old, (int, float)) or \
+           not isinstance(new, (int, float)):
+            continue
+        if new - old <= floors.get(key, 0.0):
+            continue
+        if new > old * (1.0 + tolerance / 100.0):
+            worse.append((key, old, new))
+    return worse
+
+
+def qemu_insn_count(sim, exe, args=[], env=None, stdout=subprocess.DEVNULL):
+    """ Run exe through the qemu wrapper sim with QEMU's libinsn plugin and
+        return the number of guest instructions executed, or None if the
+        program failed.  QEMU_PLUGIN_DIR must point at the installed
+        plugins.
+    """
+    plugin = os.path.join(os.environ.get("QEMU_PLUGIN_DIR", ""), "libinsn.so")
+    fd, log = tempfile.mkstemp()
+    os.close(fd)
+    try:
+        rc = subprocess.call([sim, "-Wq,-plugin", "-Wq,%s" % plugin,
+                              "-Wq,-d", "-Wq,plugin", "-Wq,-D", "-Wq,%s" % log,
+                              exe] + list(args),
+                             env=env, stdout=stdout)
+        if rc != 0:
+            return None
+        count = None
+        with open(log) as f:
+            # Newer plugins print one "cpu N insns:" line per vCPU followed
+            # by "total insns:", older ones a single "insns:" line.
+            for line in f:
+                m = re.match(r"^(total )?insns: (\d+)", line)
+                if m:
+                    count = int(m.group(2))
+        return count
+    finally:
+        os.remove(log)
+
+
+def target_configs(configs, cmodel="medlow"):
+    """ Expand CONFIGS, in the syntax of --with-extra-multilib-test, with
+        generate_target_board and return (label, compiler flags) for every
+        configuration.  The label is <arch>-<abi> followed by the extra
+        flags, separated by '/', with '=' replaced by ':' so it can be
+        part of a result line.
+    """
+    # Makefiles may split long lists over several lines.
+    configs = ";".join(c.strip() for c in configs.split(";") if c.strip())
+    first, _, rest = configs.partition(";")
+    script = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..",
+                          "..", "..", "scripts", "generate_target_board")
+    boards = subprocess.check_output(
+        [sys.executable, script, "--sim-name", "bench", "--cmodel", cmodel,
+         "--build-arch-abi", first,
+         "--extra-test-arch-abi-flags-list", rest]).decode().split()
+    result = []
+    for board in boards:
+        # bench/-march=<arch>/-mabi=<abi>/-mcmodel=<cmodel>[/<flag>...]
+        flags = board.split("/")[1:]
+        arch = flags[0].split("=", 1)[1]
+        abi = flags[1].split("=", 1)[1]
+        label = "/".join(["%s-%s" % (arch, abi)] + flags[3:])
+        result.append((label.replace("=", ":"), flags))
+    return result
+
+
+def kernel_insns(sim, exe, kernel, iters, count=qemu_insn_count):
+    """ Instructions per iteration of one kernel of a benchmark program that
+        takes "<kernel> <iterations>" on its command line.  Setup, startup
+        and exit cost cancel out by subtracting a run with no iterations.
+    """
+    base = count(sim, exe, [kernel, "0"])
+    full = count(sim, exe, [kernel, str(iters)])
+    if base is None or full is None:
+        return None
+    return float(full - base) / iters
+
+
+def march_supported(cc, march, mabi):
+    """ Whether cc accepts -march=MARCH -mabi=MABI, e.g. to skip the
+        extensions an older GCC does not know.
+    """
+    cmd = [cc, "-march=%s" % march, "-mabi=%s" % mabi, "-fsyntax-only",
+           "-x", "c", os.devnull]
+    return subprocess.call(cmd, stdout=subprocess.DEVNULL,
+                           stderr=subprocess.DEVNULL) == 0
+
+
+def matches_reference(reference, kernel, out, label, compare=None):
+    """ Whether OUT, the output of KERNEL, matches the first output seen
+        for it, which is kept in the dict REFERENCE.  COMPARE(kernel, out,
+        expected) replaces the test for equality.  A mismatch is written
+        to stderr, prefixed with LABEL.
+    """
+    if out:
+        expected = reference.setdefault(kernel, out)
+        if compare(kernel, out, expected) if compare else out == expected:
+            return True
+    sys.stderr.write("%s %s: wrong result %r, expected %r\n"
+                     % (label, kernel, out, reference.get(kernel)))
+    return False
+
+
+def run_kernels(sim, exe, label, reference, iters, compare=None, env=None,
+                count=qemu_insn_count):
+    """ Run every kernel of EXE, a benchmark program that lists its kernels
+        when run without arguments, one per line and optionally followed
+        by more words, and otherwise takes "<kernel> <iterations>".  Each
+        kernel is run for 2 iterations and checked with matches_reference
+        before its instructions per iteration are counted.  Return a list
+        of (words of the listing line, instructions per iteration or None
+        if the kernel failed), or None if EXE could not list its kernels.
+    """
+    proc = subprocess.run([sim, exe], env=env, stdout=subprocess.PIPE)
+    if proc.returncode != 0:
+        return None
+    results = []
+    for words in [l.split() for l in proc.stdout.decode().splitlines()]:
+        if not words:
+            continue
+        kernel = words[0]
+        run = subprocess.run([sim, exe, kernel, "2"], env=env,
+                             stdout=subprocess.PIPE)
+        insns = None
+        if matches_reference(reference, kernel,
+                             run.stdout.decode() if run.returncode == 0
+                             else None, label, compare):
+            insns = kernel_insns(sim, exe, kernel, iters,
+                                 functools.partial(count, env=env))
+        results.append((words, insns))
+    return results
+
+
+def percent_delta(baseline, key, val):
+    """ The difference of VAL in percent to the first value seen for KEY,
+        which is kept in the dict BASELINE.
+    """
+    base = baseline.setdefault(key, val)
+    return 100.0 * (val - base) / base if base else 0.0
+
+
+def write_results(path, lines):
+    with open(path, "w") as f:
+        for line in lines:
+            f.write(line + "\n")
+
+
+def write_error(path, ident):
+    """ Write an ERROR line to path.  Drivers call this before measuring
+        anything, like dhrystone/check, so that the report still fails
+        if an exception stops them before write_results.
+    """
+    write_results(path, [format_result("ERROR", ident + ["failed to run"],
+                                       {})])
@@ -0,0 +1,303 @@
+// See LICENSE for license details.
+
+//**************************************************************************
+// Compile-time corpus: bytecode interpreter
+//--------------------------------------------------------------------------
+//
+// A small stack machine with a large dispatch switch, a tokenizer and a
+// hash table.  Big switch statements and many small static functions keep
+// the RTL passes (combine, register allocation, scheduling) busy.
+//
+
+#include <ctype.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum opcode
+{
+  OP_PUSH, OP_POP, OP_DUP, OP_SWAP, OP_OVER, OP_ROT,
+  OP_ADD, OP_SUB, OP_MUL, OP_DIV, OP_MOD, OP_NEG,
+  OP_AND, OP_OR, OP_XOR, OP_NOT, OP_SHL, OP_SHR,
+  OP_EQ, OP_NE, OP_LT, OP_LE, OP_GT, OP_GE,
+  OP_JMP, OP_JZ, OP_JNZ, OP_CALL, OP_RET,
+  OP_LOAD, OP_STORE, OP_GLOAD, OP_GSTORE,
+  OP_PRINT, OP_HALT, OP_NUM_OPS
+};
+
+struct insn
+{
+  uint8_t op;
+  int32_t arg;
+};
+
+#define STACK_SIZE 256
+#define FRAME_SIZE 16
+#define GLOBALS 64
+#define HASH_BUCKETS 127
+
+struct vm
+{
+  int64_t stack[STACK_SIZE];
+  int64_t frames[STACK_SIZE][FRAME_SIZE];
+  int64_t globals[GLOBALS];
+  int ret_stack[STACK_SIZE];
+  int sp, fp, rp;
+  uint64_t steps;
+};
+
+struct symbol
+{
+  char name[32];
+  int value;
+  struct symbol *next;
+};
+
+static struct symbol *symtab[HASH_BUCKETS];
+
+static unsigned
+hash_name (const char *s)
+{
+  unsigned h = 2166136261u;
+  while (*s)
+    h = (h ^ (unsigned char) *s++) * 16777619u;
+  return h % HASH_BUCKETS;
+}
+
+static struct symbol *
+lookup (const char *name, int create)
+{
+  unsigned h = hash_name (name);
+  struct symbol *s;
+  for (s = symtab[h]; s; s = s->next)
+    if (strcmp (s->name, name) == 0)
+      return s;
+  if (!create)
+    return NULL;
+  s = calloc (1, sizeof (*s));
+  strncpy (s->name, name, sizeof (s->name) - 1);
+  s->next = symtab[h];
+  symtab[h] = s;
+  return s;
+}
+
+static const struct
+{
+  const char *name;
+  enum opcode op;
+  int has_arg;
+} mnemonics[] = {
+  { "push", OP_PUSH, 1 }, { "pop", OP_POP, 0 }, { "dup", OP_DUP, 0 },
+  { "swap", OP_SWAP, 0 }, { "over", OP_OVER, 0 }, { "rot", OP_ROT, 0 },
+  { "add", OP_ADD, 0 }, { "sub", OP_SUB, 0 }, { "mul", OP_MUL, 0 },
+  { "div", OP_DIV, 0 }, { "mod", OP_MOD, 0 }, { "neg", OP_NEG, 0 },
+  { "and", OP_AND, 0 }, { "or", OP_OR, 0 }, { "xor", OP_XOR, 0 },
+  { "not", OP_NOT, 0 }, { "shl", OP_SHL, 0 }, { "shr", OP_SHR, 0 },
+  { "eq", OP_EQ, 0 }, { "ne", OP_NE, 0 }, { "lt", OP_LT, 0 },
+  { "le", OP_LE, 0 }, { "gt", OP_GT, 0 }, { "ge", OP_GE, 0 },
+  { "jmp", OP_JMP, 1 }, { "jz", OP_JZ, 1 }, { "jnz", OP_JNZ, 1 },
+  { "call", OP_CALL, 1 }, { "ret", OP_RET, 0 },
+  { "load", OP_LOAD, 1 }, { "store", OP_STORE, 1 },
+  { "gload", OP_GLOAD, 1 }, { "gstore", OP_GSTORE, 1 },
+  { "print", OP_PRINT, 0 }, { "halt", OP_HALT, 0 },
+};
+
+static const char *
+skip_space (const char *p)
+{
+  while (*p && (isspace ((unsigned char) *p) || *p == ';'))
+    {
+      if (*p == ';')
+	while (*p && *p != '\n')
+	  p++;
+      else
+	p++;
+    }
+  return p;
+}
+
+static const char *
+read_word (const char *p, char *buf, size_t len)
+{
+  size_t i = 0;
+  while (*p && !isspace ((unsigned char) *p) && i + 1 < len)
+    buf[i++] = *p++;
+  buf[i] = '\0';
+  return p;
+}
+
+static int
+assemble (const char *src, struct insn *code, int max)
+{
+  char word[32];
+  int pc = 0, pass;
+
+  for (pass = 0; pass < 2; pass++)
+    {
+      const char *p = src;
+      pc = 0;
+      while (*(p = skip_space (p)))
+	{
+	  size_t i, len;
+	  p = read_word (p, word, sizeof (word));
+	  len = strlen (word);
+	  if (len && word[len - 1] == ':')
+	    {
+	      word[len - 1] = '\0';
+	      lookup (word, 1)->value = pc;
+	      continue;
+	    }
+	  for (i = 0; i < sizeof (mnemonics) / sizeof (mnemonics[0]); i++)
+	    if (strcmp (word, mnemonics[i].name) == 0)
+	      break;
+	  if (i == sizeof (mnemonics) / sizeof (mnemonics[0]) || pc >= max)
+	    return -1;
+	  code[pc].op = mnemonics[i].op;
+	  code[pc].arg = 0;
+	  if (mnemonics[i].has_arg)
+	    {
+	      p = read_word (skip_space (p), word, sizeof (word));
+	      if (isdigit ((unsigned char) word[0]) || word[0] == '-')
+		code[pc].arg = strtol (word, NULL, 0);
+	      else if (pass == 1)
+		{
+		  struct symbol *s = lookup (word, 0);
+		  if (!s)
+		    return -1;
+		  code[pc].arg = s->value;
+		}
+	    }
+	  pc++;
+	}
+    }
+  return pc;
+}
+
+#define BINOP(op) \
+  do { vm->sp--; vm->stack[vm->sp - 1] = vm->stack[vm->sp - 1] op vm->stack[vm->sp]; } while (0)
+
+static int
+run (struct vm *vm, const struct insn *code, int len)
+{
+  int pc = 0;
+  while (pc >= 0 && pc < len)
+    {
+      const struct insn *i = &code[pc++];
+      int64_t t;
+      vm->steps++;
+      switch (i->op)
+	{
+	case OP_PUSH: vm->stack[vm->sp++] = i->arg; break;
+	case OP_POP: vm->sp--; break;
+	case OP_DUP: vm->stack[vm->sp] = vm->stack[vm->sp - 1]; vm->sp++; break;
+	case OP_SWAP:
+	  t = vm->stack[vm->sp - 1];
+	  vm->stack[vm->sp - 1] = vm->stack[vm->sp - 2];
+	  vm->stack[vm->sp - 2] = t;
+	  break;
+	case OP_OVER: vm->stack[vm->sp] = vm->stack[vm->sp - 2]; vm->sp++; break;
+	case OP_ROT:
+	  t = vm->stack[vm->sp - 3];
+	  vm->stack[vm->sp - 3] = vm->stack[vm->sp - 2];
+	  vm->stack[vm->sp - 2] = vm->stack[vm->sp - 1];
+	  vm->stack[vm->sp - 1] = t;
+	  break;
+	case OP_ADD: BINOP (+); break;
+	case OP_SUB: BINOP (-); break;
+	case OP_MUL: BINOP (*); break;
+	case OP_DIV:
+	  if (vm->stack[vm->sp - 1] == 0)
+	    return -1;
+	  BINOP (/);
+	  break;
+	case OP_MOD:
+	  if (vm->stack[vm->sp - 1] == 0)
+	    return -1;
+	  BINOP (%);
+	  break;
+	case OP_NEG: vm->stack[vm->sp - 1] = -vm->stack[vm->sp - 1]; break;
+	case OP_AND: BINOP (&); break;
+	case OP_OR: BINOP (|); break;
+	case OP_XOR: BINOP (^); break;
+	case OP_NOT: vm->stack[vm->sp - 1] = ~vm->stack[vm->sp - 1]; break;
+	case OP_SHL: BINOP (<<); break;
+	case OP_SHR: BINOP (>>); break;
+	case OP_EQ: BINOP (==); break;
+	case OP_NE: BINOP (!=); break;
+	case OP_LT: BINOP (<); break;
+	case OP_LE: BINOP (<=); break;
+	case OP_GT: BINOP (>); break;
+	case OP_GE: BINOP (>=); break;
+	case OP_JMP: pc = i->arg; break;
+	case OP_JZ: if (vm->stack[--vm->sp] == 0) pc = i->arg; break;
+	case OP_JNZ: if (vm->stack[--vm->sp] != 0) pc = i->arg; break;
+	case OP_CALL:
+	  vm->ret_stack[vm->rp++] = pc;
+	  vm->fp++;
+	  pc = i->arg;
+	  break;
+	case OP_RET:
+	  if (vm->rp == 0)
+	    return 0;
+	  vm->fp--;
+	  pc = vm->ret_stack[--vm->rp];
+	  break;
+	case OP_LOAD:
+	  vm->stack[vm->sp++] = vm->frames[vm->fp][i->arg & (FRAME_SIZE - 1)];
+	  break;
+	case OP_STORE:
+	  vm->frames[vm->fp][i->arg & (FRAME_SIZE - 1)] = vm->stack[--vm->sp];
+	  break;
+	case OP_GLOAD:
+	  vm->stack[vm->sp++] = vm->globals[i->arg & (GLOBALS - 1)];
+	  break;
+	case OP_GSTORE:
+	  vm->globals[i->arg & (GLOBALS - 1)] = vm->stack[--vm->sp];
+	  break;
+	case OP_PRINT: printf ("%lld\n", (long long) vm->stack[--vm->sp]); break;
+	case OP_HALT: return 0;
+	default: return -1;
+	}
+    }
+  return 0;
+}
+
+static const char program[] =
+  "  push 25 gstore 0          ; n\n"
+  "  push 0 gstore 1           ; acc\n"
+  "loop:\n"
+  "  gload 0 jz done\n"
+  "  gload 0 call fib gload 1 add gstore 1\n"
+  "  gload 0 push 1 sub gstore 0\n"
+  "  jmp loop\n"
+  "done:\n"
+  "  gload 1 print halt\n"
+  "fib:\n"
+  "  store 0 push 0 store 1 push 1 store 2\n"
+  "fibloop:\n"
+  "  load 0 jz fibdone\n"
+  "  load 1 load 2 dup store 1 add store 2\n"
+  "  load 0 push 1 sub store 0 jmp fibloop\n"
+  "fibdone:\n"
+  "  load 1 ret\n";
+
+int
+main (void)
+{
+  static struct insn code[512];
+  static struct vm vm;
+  int len = assemble (program, code, 512);
+  if (len < 0)
+    {
+      puts ("assembly failed");
+      return 1;
+    }
+  if (run (&vm, code, len) != 0)
+    {
+      puts ("execution failed");
+      return 1;
+    }
+  printf ("%llu steps\n", (unsigned long long) vm.steps);
+  return 0;
+}
@@ -0,0 +1,196 @@
+// See LICENSE for license details.
+
+//**************************************************************************
+// Compile-time corpus: libstdc++ heavy translation unit
+//--------------------------------------------------------------------------
+//
+// Pulls in roughly the header set of <bits/stdc++.h> and instantiates the
+// common containers and algorithms over several element types, which is
+// where most of the front-end and inliner time goes in real C++ code.
+//
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <deque>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <queue>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace {
+
+struct Point
+{
+  double x, y;
+  bool operator< (const Point &o) const
+  { return std::tie (x, y) < std::tie (o.x, o.y); }
+  bool operator== (const Point &o) const
+  { return x == o.x && y == o.y; }
+};
+
+struct PointHash
+{
+  std::size_t operator() (const Point &p) const
+  {
+    return std::hash<double> () (p.x) * 31 ^ std::hash<double> () (p.y);
+  }
+};
+
+template <typename T>
+T
+make_value (unsigned i)
+{
+  if constexpr (std::is_same_v<T, std::string>)
+    return "value-" + std::to_string (i);
+  else if constexpr (std::is_same_v<T, Point>)
+    return Point{ double (i % 97), double (i / 97) };
+  else
+    return T (i * 2654435761u);
+}
+
+template <typename T, typename Hash = std::hash<T>>
+std::size_t
+exercise_containers (unsigned n)
+{
+  std::vector<T> vec;
+  std::deque<T> deq;
+  std::list<T> lst;
+  for (unsigned i = 0; i < n; i++)
+    {
+      T v = make_value<T> (i);
+      vec.push_back (v);
+      deq.push_front (v);
+      lst.push_back (std::move (v));
+    }
+
+  std::sort (vec.begin (), vec.end ());
+  vec.erase (std::unique (vec.begin (), vec.end ()), vec.end ());
+  std::stable_sort (deq.begin (), deq.end ());
+  lst.sort ();
+
+  std::set<T> ordered (vec.begin (), vec.end ());
+  std::map<T, unsigned> counts;
+  for (const T &v : deq)
+    counts[v]++;
+
+  std::unordered_set<T, Hash> hashed (lst.begin (), lst.end ());
+  std::unordered_map<T, std::vector<unsigned>, Hash> index;
+  unsigned pos = 0;
+  for (const T &v : vec)
+    index[v].push_back (pos++);
+
+  std::priority_queue<T> heap (vec.begin (), vec.end ());
+  std::size_t total = ordered.size () + counts.size () + hashed.size ();
+  while (!heap.empty ())
+    {
+      total += index.count (heap.top ());
+      heap.pop ();
+    }
+
+  auto it = std::lower_bound (vec.begin (), vec.end (), make_value<T> (n / 2));
+  total += std::distance (vec.begin (), it);
+  return total;
+}
+
+using Shape = std::variant<int, double, std::string, Point>;
+
+std::string
+describe (const Shape &s)
+{
+  return std::visit ([] (const auto &v) -> std::string {
+      using V = std::decay_t<decltype (v)>;
+      std::ostringstream os;
+      if constexpr (std::is_same_v<V, Point>)
+	os << "point(" << std::setprecision (3) << v.x << "," << v.y << ")";
+      else
+	os << std::fixed << v;
+      return os.str ();
+    }, s);
+}
+
+std::optional<std::size_t>
+find_word (std::string_view text, std::string_view word)
+{
+  auto pos = text.find (word);
+  if (pos == std::string_view::npos)
+    return std::nullopt;
+  return pos;
+}
+
+double
+simulate (unsigned seed)
+{
+  std::mt19937_64 gen (seed);
+  std::normal_distribution<double> normal (0.0, 1.0);
+  std::uniform_int_distribution<int> dice (1, 6);
+  std::vector<std::complex<double>> samples;
+  for (int i = 0; i < 256; i++)
+    samples.emplace_back (normal (gen), dice (gen));
+  std::complex<double> sum
+    = std::accumulate (samples.begin (), samples.end (),
+		       std::complex<double> ());
+  std::array<double, 8> buckets{};
+  std::transform (samples.begin (), samples.begin () + 8, buckets.begin (),
+		  [] (const std::complex<double> &c) { return std::abs (c); });
+  return std::abs (sum) + *std::max_element (buckets.begin (), buckets.end ());
+}
+
+} // anonymous namespace
+
+int
+main (int argc, char **argv)
+{
+  unsigned n = argc > 1 ? std::stoul (argv[1]) : 1000;
+  std::size_t total = 0;
+  total += exercise_containers<int> (n);
+  total += exercise_containers<long long> (n);
+  total += exercise_containers<double> (n);
+  total += exercise_containers<std::string> (n);
+  total += exercise_containers<Point, PointHash> (n);
+
+  std::vector<std::unique_ptr<Shape>> shapes;
+  shapes.push_back (std::make_unique<Shape> (42));
+  shapes.push_back (std::make_unique<Shape> (3.5));
+  shapes.push_back (std::make_unique<Shape> (std::string ("text")));
+  shapes.push_back (std::make_unique<Shape> (Point{ 1, 2 }));
+  std::function<void (const std::unique_ptr<Shape> &)> print
+    = [] (const std::unique_ptr<Shape> &s) {
+	std::cout << describe (*s) << '\n';
+      };
+  std::for_each (shapes.begin (), shapes.end (), print);
+
+  std::bitset<128> bits;
+  for (unsigned i = 0; i < 128; i += 3)
+    bits.set (i);
+
+  auto start = std::chrono::steady_clock::now ();
+  double sim = simulate (n);
+  auto elapsed = std::chrono::steady_clock::now () - start;
+
+  std::cout << total << ' ' << bits.count () << ' ' << sim << ' '
+	    << find_word ("compile time corpus", "time").value_or (0) << ' '
+	    << std::chrono::duration_cast<std::chrono::microseconds> (elapsed)
+		 .count ()
+	    << std::endl;
+  return 0;
+}
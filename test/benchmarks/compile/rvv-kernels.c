@@ -0,0 +1,120 @@
+// See LICENSE for license details.
+
+//**************************************************************************
+// Compile-time corpus: RVV intrinsics
+//--------------------------------------------------------------------------
+//
+// Including riscv_vector.h registers several thousand intrinsic builtins,
+// and strip-mined loops over them exercise the vsetvl insertion pass.
+// The check script compiles this file with V added to -march.
+//
+
+#include <riscv_vector.h>
+#include <stddef.h>
+#include <stdint.h>
+
+void
+saxpy (size_t n, float a, const float *x, float *y)
+{
+  for (size_t vl; n > 0; n -= vl, x += vl, y += vl)
+    {
+      vl = __riscv_vsetvl_e32m8 (n);
+      vfloat32m8_t vx = __riscv_vle32_v_f32m8 (x, vl);
+      vfloat32m8_t vy = __riscv_vle32_v_f32m8 (y, vl);
+      vy = __riscv_vfmacc_vf_f32m8 (vy, a, vx, vl);
+      __riscv_vse32_v_f32m8 (y, vy, vl);
+    }
+}
+
+void
+vec_mul_add (size_t n, const double *a, const double *b, double *c)
+{
+  for (size_t vl; n > 0; n -= vl, a += vl, b += vl, c += vl)
+    {
+      vl = __riscv_vsetvl_e64m4 (n);
+      vfloat64m4_t va = __riscv_vle64_v_f64m4 (a, vl);
+      vfloat64m4_t vb = __riscv_vle64_v_f64m4 (b, vl);
+      vfloat64m4_t vc = __riscv_vle64_v_f64m4 (c, vl);
+      vc = __riscv_vfadd_vv_f64m4 (__riscv_vfmul_vv_f64m4 (va, vb, vl),
+				   vc, vl);
+      __riscv_vse64_v_f64m4 (c, vc, vl);
+    }
+}
+
+int32_t
+sum_i32 (size_t n, const int32_t *x)
+{
+  vint32m1_t acc = __riscv_vmv_s_x_i32m1 (0, 1);
+  for (size_t vl; n > 0; n -= vl, x += vl)
+    {
+      vl = __riscv_vsetvl_e32m8 (n);
+      vint32m8_t vx = __riscv_vle32_v_i32m8 (x, vl);
+      acc = __riscv_vredsum_vs_i32m8_i32m1 (vx, acc, vl);
+    }
+  return __riscv_vmv_x_s_i32m1_i32 (acc);
+}
+
+void *
+vec_memcpy (void *dst, const void *src, size_t n)
+{
+  uint8_t *d = dst;
+  const uint8_t *s = src;
+  for (size_t vl; n > 0; n -= vl, s += vl, d += vl)
+    {
+      vl = __riscv_vsetvl_e8m8 (n);
+      vuint8m8_t v = __riscv_vle8_v_u8m8 (s, vl);
+      __riscv_vse8_v_u8m8 (d, v, vl);
+    }
+  return dst;
+}
+
+size_t
+vec_strlen (const char *str)
+{
+  const uint8_t *p = (const uint8_t *) str;
+  for (;;)
+    {
+      size_t vl = __riscv_vsetvlmax_e8m8 ();
+      vuint8m8_t v = __riscv_vle8ff_v_u8m8 (p, &vl, vl);
+      vbool1_t zero = __riscv_vmseq_vx_u8m8_b1 (v, 0, vl);
+      long first = __riscv_vfirst_m_b1 (zero, vl);
+      if (first >= 0)
+	return (const char *) p - str + first;
+      p += vl;
+    }
+}
+
+void
+widen_add (size_t n, const int16_t *a, const int16_t *b, int32_t *c)
+{
+  for (size_t vl; n > 0; n -= vl, a += vl, b += vl, c += vl)
+    {
+      vl = __riscv_vsetvl_e16m4 (n);
+      vint16m4_t va = __riscv_vle16_v_i16m4 (a, vl);
+      vint16m4_t vb = __riscv_vle16_v_i16m4 (b, vl);
+      __riscv_vse32_v_i32m8 (c, __riscv_vwadd_vv_i32m8 (va, vb, vl), vl);
+    }
+}
+
+void
+relu (size_t n, float *x)
+{
+  for (size_t vl; n > 0; n -= vl, x += vl)
+    {
+      vl = __riscv_vsetvl_e32m8 (n);
+      vfloat32m8_t v = __riscv_vle32_v_f32m8 (x, vl);
+      __riscv_vse32_v_f32m8 (x, __riscv_vfmax_vf_f32m8 (v, 0.0f, vl), vl);
+    }
+}
+
+void
+gather_i32 (size_t n, const int32_t *base, const uint32_t *idx, int32_t *out)
+{
+  for (size_t vl; n > 0; n -= vl, idx += vl, out += vl)
+    {
+      vl = __riscv_vsetvl_e32m4 (n);
+      vuint32m4_t vi = __riscv_vle32_v_u32m4 (idx, vl);
+      vi = __riscv_vsll_vx_u32m4 (vi, 2, vl);
+      __riscv_vse32_v_i32m4 (out, __riscv_vluxei32_v_i32m4 (base, vi, vl), vl);
+    }
+}
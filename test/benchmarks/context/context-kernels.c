@@ -0,0 +1,422 @@
+// See LICENSE for license details.
+
+//**************************************************************************
+// Signal delivery and context switch kernels
+//--------------------------------------------------------------------------
+//
+// Usage: context-kernels <kernel> <iterations>, context-kernels frame [v]
+// to print the size of a signal frame and of its vector state, or no
+// arguments to list the kernels.  Every kernel prints the number of
+// completed round trips, which must not depend on VLEN, and the bench.h
+// result line of its loop.
+//
+// signal sends itself SIGUSR1 with a raw kill system call, so nothing but
+// the delivery, the handler and rt_sigreturn runs between two
+// iterations.  setjmp and sigsetjmp do a setjmp/longjmp round trip, the
+// latter saving and restoring the signal mask.  swapcontext switches to a
+// coroutine and back, makecontext creates a fresh context every time and
+// returns through uc_link; glibc only, as musl has no ucontext functions.
+//
+// The _v kernels first make the vector state live (all of v8-v15 at
+// e8/m8), so Linux has to save it in every signal frame and discard it on
+// every system call.  signal_v also clobbers the vector
+// registers and vtype in the handler and only counts a round trip if
+// sigreturn restored them.  The layout of the extended signal context
+// (RISCV_V_MAGIC, up to RISCV_MAX_VLENB per register) comes from
+// asm/sigcontext.h, which cannot be included next to the libc headers.
+//
+
+#include <setjmp.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#ifdef __GLIBC__
+#include <ucontext.h>
+#endif
+
+#include "bench.h"
+
+// struct __riscv_ctx_hdr magics.
+#define CTX_END_MAGIC 0
+#define CTX_V_MAGIC 0x53465457
+
+// The first extension header sits in the last 8 bytes of the 528 byte
+// floating-point state that follows the 32 integer registers.
+#define CTX_HDR_OFFSET (32 * sizeof (unsigned long) + 520)
+
+// Large enough for the signal frame at RISCV_MAX_VLENB.
+#define ALTSTACK_SIZE (1024 * 1024)
+
+#define STACK_SIZE (64 * 1024)
+
+static volatile unsigned long signals;
+static volatile int vector_live;
+
+static char altstack[ALTSTACK_SIZE] __attribute__ ((aligned (16)));
+static size_t frame_bytes, vstate_bytes;
+
+#ifdef __riscv_vector
+#define VECTOR_CLOBBERS "v8", "v9", "v10", "v11", "v12", "v13", "v14", \
+  "v15", "v16", "v17", "v18", "v19", "v20", "v21", "v22", "v23", "vl", "vtype"
+
+static inline void
+vector_dirty (unsigned long seed)
+{
+  asm volatile ("vsetvli t0, zero, e8, m8, ta, ma\n\t"
+		"vid.v v8\n\t"
+		"vadd.vx v8, v8, %0"
+		: : "r"(seed) : "t0", VECTOR_CLOBBERS);
+}
+
+static inline void
+vector_clobber (void)
+{
+  asm volatile ("vsetvli t0, zero, e64, m8, ta, ma\n\t"
+		"vmv.v.i v8, 0"
+		: : : "t0", VECTOR_CLOBBERS);
+}
+
+// The e8 sum of vid.v + SEED over all VLMAX elements of an m8 group.
+static uint8_t
+vector_expected (unsigned long seed)
+{
+  static unsigned long vlmax;
+  static uint8_t vid_sum;
+
+  if (vlmax == 0)
+    {
+      asm ("csrr %0, vlenb" : "=r"(vlmax));
+      vlmax *= 8;
+      for (unsigned long i = 0; i < vlmax; i++)
+	vid_sum += (uint8_t) i;
+    }
+  return (uint8_t) (vid_sum + vlmax * seed);
+}
+#endif
+
+static void
+handler (int sig, siginfo_t *info, void *context)
+{
+  const ucontext_t *uc = context;
+  const char *top = altstack + ALTSTACK_SIZE;
+  const char *hdr = (const char *) &uc->uc_mcontext + CTX_HDR_OFFSET;
+
+  (void) sig;
+  signals++;
+#ifdef __riscv_vector
+  if (vector_live)
+    vector_clobber ();
+#endif
+
+  // Only the frame kernel runs on the alternate stack.
+  if ((const char *) info < altstack || (const char *) info >= top)
+    return;
+  frame_bytes = top - (const char *) info;
+  vstate_bytes = 0;
+  while (hdr + 8 <= top)
+    {
+      uint32_t magic, size;
+
+      memcpy (&magic, hdr, sizeof magic);
+      memcpy (&size, hdr + 4, sizeof size);
+      if (magic == CTX_END_MAGIC || size < 8)
+	break;
+      if (magic == CTX_V_MAGIC)
+	vstate_bytes = size;
+      hdr += size;
+    }
+}
+
+static inline void
+raise_usr1 (pid_t pid)
+{
+  register long a0 asm ("a0") = pid;
+  register long a1 asm ("a1") = SIGUSR1;
+  register long a7 asm ("a7") = SYS_kill;
+
+  asm volatile ("ecall" : "+r"(a0) : "r"(a1), "r"(a7) : "memory");
+}
+
+static uint64_t
+signal_scalar (unsigned long iters)
+{
+  pid_t pid = getpid ();
+
+  for (unsigned long it = 0; it < iters; it++)
+    raise_usr1 (pid);
+  return signals;
+}
+
+static jmp_buf jmp_env;
+static sigjmp_buf sigjmp_env;
+
+static void __attribute__ ((noinline))
+jump (void)
+{
+  longjmp (jmp_env, 1);
+}
+
+static void __attribute__ ((noinline))
+sigjump (void)
+{
+  siglongjmp (sigjmp_env, 1);
+}
+
+static uint64_t
+setjmp_scalar (unsigned long iters)
+{
+  volatile uint64_t count = 0;
+
+  for (unsigned long it = 0; it < iters; it++)
+    {
+#ifdef __riscv_vector
+      if (vector_live)
+	vector_dirty (it);
+#endif
+      if (setjmp (jmp_env) == 0)
+	jump ();
+      count++;
+    }
+  return count;
+}
+
+static uint64_t
+sigsetjmp_scalar (unsigned long iters)
+{
+  volatile uint64_t count = 0;
+
+  for (unsigned long it = 0; it < iters; it++)
+    {
+#ifdef __riscv_vector
+      if (vector_live)
+	vector_dirty (it);
+#endif
+      if (sigsetjmp (sigjmp_env, 1) == 0)
+	sigjump ();
+      count++;
+    }
+  return count;
+}
+
+#ifdef __GLIBC__
+static ucontext_t main_ctx, co_ctx;
+static char co_stack[STACK_SIZE] __attribute__ ((aligned (16)));
+static volatile uint64_t switches;
+
+static void
+coroutine (void)
+{
+  for (;;)
+    {
+      switches++;
+      swapcontext (&co_ctx, &main_ctx);
+    }
+}
+
+static void
+leaf (void)
+{
+  switches++;
+}
+
+static uint64_t
+swapcontext_scalar (unsigned long iters)
+{
+  getcontext (&co_ctx);
+  co_ctx.uc_stack.ss_sp = co_stack;
+  co_ctx.uc_stack.ss_size = sizeof co_stack;
+  co_ctx.uc_link = NULL;
+  makecontext (&co_ctx, coroutine, 0);
+
+  for (unsigned long it = 0; it < iters; it++)
+    {
+#ifdef __riscv_vector
+      if (vector_live)
+	vector_dirty (it);
+#endif
+      swapcontext (&main_ctx, &co_ctx);
+    }
+  return switches;
+}
+
+static uint64_t
+makecontext_scalar (unsigned long iters)
+{
+  for (unsigned long it = 0; it < iters; it++)
+    {
+#ifdef __riscv_vector
+      if (vector_live)
+	vector_dirty (it);
+#endif
+      getcontext (&co_ctx);
+      co_ctx.uc_stack.ss_sp = co_stack;
+      co_ctx.uc_stack.ss_size = sizeof co_stack;
+      co_ctx.uc_link = &main_ctx;
+      makecontext (&co_ctx, leaf, 0);
+      swapcontext (&main_ctx, &co_ctx);
+    }
+  return switches;
+}
+#endif
+
+#ifdef __riscv_vector
+// Every iteration loads v8-v15 with vid.v + it, takes the signal right
+// after the ecall and then sums the registers with the vtype it set up,
+// which only gives the expected value if sigreturn restored both.
+static uint64_t
+signal_v (unsigned long iters)
+{
+  pid_t pid = getpid ();
+  uint64_t restored = 0;
+
+  vector_expected (0);
+  vector_live = 1;
+  for (unsigned long it = 0; it < iters; it++)
+    {
+      register long a0 asm ("a0") = pid;
+      register long a1 asm ("a1") = SIGUSR1;
+      register long a7 asm ("a7") = SYS_kill;
+      unsigned long sum;
+
+      asm volatile ("vsetvli t0, zero, e8, m8, ta, ma\n\t"
+		    "vid.v v8\n\t"
+		    "vadd.vx v8, v8, %[seed]\n\t"
+		    "ecall\n\t"
+		    "vmv.s.x v16, zero\n\t"
+		    "vredsum.vs v16, v8, v16\n\t"
+		    "vmv.x.s %[sum], v16"
+		    : [sum] "=r"(sum), "+r"(a0)
+		    : [seed] "r"(it), "r"(a1), "r"(a7)
+		    : "t0", "memory", VECTOR_CLOBBERS);
+      restored += (uint8_t) sum == vector_expected (it);
+    }
+  return signals == iters ? restored : 0;
+}
+
+static uint64_t
+setjmp_v (unsigned long iters)
+{
+  vector_live = 1;
+  return setjmp_scalar (iters);
+}
+
+static uint64_t
+sigsetjmp_v (unsigned long iters)
+{
+  vector_live = 1;
+  return sigsetjmp_scalar (iters);
+}
+
+#ifdef __GLIBC__
+static uint64_t
+swapcontext_v (unsigned long iters)
+{
+  vector_live = 1;
+  return swapcontext_scalar (iters);
+}
+
+static uint64_t
+makecontext_v (unsigned long iters)
+{
+  vector_live = 1;
+  return makecontext_scalar (iters);
+}
+#endif
+#endif
+
+// Deliver one signal on the alternate stack and print the size of its
+// frame and of the vector state in it.
+static int
+frame (int vector)
+{
+  pid_t pid = getpid ();
+  stack_t ss;
+
+  memset (&ss, 0, sizeof ss);
+  ss.ss_sp = altstack;
+  ss.ss_size = sizeof altstack;
+  if (sigaltstack (&ss, NULL) != 0)
+    return 1;
+#ifdef __riscv_vector
+  if (vector)
+    vector_dirty (1);
+#else
+  if (vector)
+    return 1;
+#endif
+  raise_usr1 (pid);
+  printf ("frame %lu %lu\n", (unsigned long) frame_bytes,
+	  (unsigned long) vstate_bytes);
+  return 0;
+}
+
+static const struct
+{
+  const char *name;
+  uint64_t (*run) (unsigned long);
+} kernels[] = {
+  { "signal", signal_scalar },
+  { "setjmp", setjmp_scalar },
+  { "sigsetjmp", sigsetjmp_scalar },
+#ifdef __GLIBC__
+  { "swapcontext", swapcontext_scalar },
+  { "makecontext", makecontext_scalar },
+#endif
+#ifdef __riscv_vector
+  { "signal_v", signal_v },
+  { "setjmp_v", setjmp_v },
+  { "sigsetjmp_v", sigsetjmp_v },
+#ifdef __GLIBC__
+  { "swapcontext_v", swapcontext_v },
+  { "makecontext_v", makecontext_v },
+#endif
+#endif
+};
+
+#define KERNEL_COUNT (sizeof (kernels) / sizeof (kernels[0]))
+
+int
+main (int argc, char **argv)
+{
+  struct sigaction sa;
+  size_t i;
+
+  if (argc < 2 || (argc < 3 && strcmp (argv[1], "frame") != 0))
+    {
+      for (i = 0; i < KERNEL_COUNT; i++)
+	printf ("%s\n", kernels[i].name);
+      return 0;
+    }
+
+  memset (&sa, 0, sizeof sa);
+  sa.sa_sigaction = handler;
+  sa.sa_flags = SA_SIGINFO | SA_ONSTACK;
+  sigemptyset (&sa.sa_mask);
+  if (sigaction (SIGUSR1, &sa, NULL) != 0)
+    return 1;
+
+  if (strcmp (argv[1], "frame") == 0)
+    return frame (argc > 2 && strcmp (argv[2], "v") == 0);
+
+  for (i = 0; i < KERNEL_COUNT; i++)
+    if (strcmp (kernels[i].name, argv[1]) == 0)
+      {
+	unsigned long iters = strtoul (argv[2], NULL, 0);
+	bench_region_t region;
+	uint64_t count;
+
+	bench_begin (&region);
+	count = kernels[i].run (iters);
+	bench_end (&region);
+	printf ("%s %llu\n", argv[1], (unsigned long long) count);
+	bench_report (argv[1], &region, iters);
+	return 0;
+      }
+
+  fprintf (stderr, "unknown kernel %s\n", argv[1]);
+  return 1;
+}
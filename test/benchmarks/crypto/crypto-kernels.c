@@ -0,0 +1,982 @@
+// See LICENSE for license details.
+
+//**************************************************************************
+// Cryptography kernels
+//--------------------------------------------------------------------------
+//
+// Usage: crypto-kernels <kernel> <iterations>, or no arguments to list the
+// kernels as "<kernel> <bytes per iteration> <implementation>".  Every
+// kernel prints a checksum that must not depend on -march.
+//
+// The implementation is picked at compile time from the extensions in
+// -march, falling back to plain C:
+//
+//   aes128_gcm: AES with Zvkned, or Zkne on RV64; GHASH with Zvkg, or
+//               Zbkc/Zbc clmul and Zbkb brev8 on RV64.
+//   sha256:     Zvknha/Zvknhb, or Zknh.
+//   chacha20:   V, rotating with Zvkb when available; the C version
+//               rotates with Zbb/Zbkb when available.
+//
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef __riscv_vector
+#include <riscv_vector.h>
+#endif
+
+#define BYTES 4096
+
+#if defined (__riscv_zvkned)
+#define AES_IMPL "zvkned"
+#define AES_ZVKNED 1
+#elif defined (__riscv_zkne) && __riscv_xlen == 64
+#define AES_IMPL "zkne"
+#define AES_ZKNE 1
+#else
+#define AES_IMPL "c"
+#endif
+
+#if defined (__riscv_zvkg)
+#define GHASH_IMPL "zvkg"
+#define GHASH_ZVKG 1
+#elif (defined (__riscv_zbkc) || defined (__riscv_zbc)) \
+      && defined (__riscv_zbkb) && __riscv_xlen == 64
+#define GHASH_IMPL "clmul"
+#define GHASH_CLMUL 1
+#else
+#define GHASH_IMPL "c"
+#endif
+
+#if defined (__riscv_zvknha) || defined (__riscv_zvknhb)
+#define SHA256_IMPL "zvknha"
+#define SHA256_ZVKNHA 1
+#elif defined (__riscv_zknh)
+#define SHA256_IMPL "zknh"
+#define SHA256_ZKNH 1
+#else
+#define SHA256_IMPL "c"
+#endif
+
+#if defined (__riscv_vector) && defined (__riscv_zvkb)
+#define CHACHA20_IMPL "v+zvkb"
+#define CHACHA20_V 1
+#elif defined (__riscv_vector)
+#define CHACHA20_IMPL "v"
+#define CHACHA20_V 1
+#else
+#define CHACHA20_IMPL "c"
+#endif
+
+#define ALIGNED __attribute__ ((aligned (16)))
+
+static uint8_t buf[BYTES] ALIGNED;
+
+static uint32_t
+load_be32 (const uint8_t *p)
+{
+  return ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16)
+	 | ((uint32_t) p[2] << 8) | p[3];
+}
+
+static void
+store_be32 (uint8_t *p, uint32_t v)
+{
+  p[0] = v >> 24;
+  p[1] = v >> 16;
+  p[2] = v >> 8;
+  p[3] = v;
+}
+
+static uint32_t
+load_le32 (const uint8_t *p)
+{
+  return p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16)
+	 | ((uint32_t) p[3] << 24);
+}
+
+static uint64_t
+load_le64 (const uint8_t *p)
+{
+  return load_le32 (p) | ((uint64_t) load_le32 (p + 4) << 32);
+}
+
+static void
+store_le64 (uint8_t *p, uint64_t v)
+{
+  for (int i = 0; i < 8; i++)
+    p[i] = v >> (8 * i);
+}
+
+static uint64_t
+fold (uint64_t sum, const uint8_t *p, size_t len)
+{
+  for (size_t i = 0; i < len; i++)
+    sum = (sum ^ p[i]) * 0x100000001b3ull;
+  return sum;
+}
+
+// Scalar crypto instructions, written as asm so this does not depend on
+// the intrinsics a particular GCC version provides.
+
+#if AES_ZKNE
+static inline uint64_t
+aes64es (uint64_t rs1, uint64_t rs2)
+{
+  uint64_t rd;
+  asm ("aes64es %0, %1, %2" : "=r"(rd) : "r"(rs1), "r"(rs2));
+  return rd;
+}
+
+static inline uint64_t
+aes64esm (uint64_t rs1, uint64_t rs2)
+{
+  uint64_t rd;
+  asm ("aes64esm %0, %1, %2" : "=r"(rd) : "r"(rs1), "r"(rs2));
+  return rd;
+}
+
+#define aes64ks1i(rs1, rnum) ({ uint64_t __rd; \
+  asm ("aes64ks1i %0, %1, %2" : "=r"(__rd) : "r"(rs1), "i"(rnum)); \
+  __rd; })
+
+static inline uint64_t
+aes64ks2 (uint64_t rs1, uint64_t rs2)
+{
+  uint64_t rd;
+  asm ("aes64ks2 %0, %1, %2" : "=r"(rd) : "r"(rs1), "r"(rs2));
+  return rd;
+}
+#endif
+
+#if GHASH_CLMUL
+static inline uint64_t
+clmul (uint64_t rs1, uint64_t rs2)
+{
+  uint64_t rd;
+  asm ("clmul %0, %1, %2" : "=r"(rd) : "r"(rs1), "r"(rs2));
+  return rd;
+}
+
+static inline uint64_t
+clmulh (uint64_t rs1, uint64_t rs2)
+{
+  uint64_t rd;
+  asm ("clmulh %0, %1, %2" : "=r"(rd) : "r"(rs1), "r"(rs2));
+  return rd;
+}
+
+static inline uint64_t
+brev8 (uint64_t rs1)
+{
+  uint64_t rd;
+  asm ("brev8 %0, %1" : "=r"(rd) : "r"(rs1));
+  return rd;
+}
+#endif
+
+#if SHA256_ZKNH
+#define SHA256_INSN(insn) \
+static inline uint32_t \
+insn (uint32_t rs1) \
+{ \
+  unsigned long rd; \
+  asm (#insn " %0, %1" : "=r"(rd) : "r"((unsigned long) rs1)); \
+  return rd; \
+}
+SHA256_INSN (sha256sig0)
+SHA256_INSN (sha256sig1)
+SHA256_INSN (sha256sum0)
+SHA256_INSN (sha256sum1)
+#endif
+
+//--------------------------------------------------------------------------
+// AES-128
+
+// The S-box, computed by aes_init so it cannot be mistyped.
+static uint8_t sbox[256];
+
+static uint8_t
+xtime (uint8_t x)
+{
+  return (x << 1) ^ ((x >> 7) * 0x1b);
+}
+
+static void
+aes_init (void)
+{
+  uint8_t p = 1, q = 1;
+
+  // p runs through the multiplicative group generated by 3, q through its
+  // inverses.
+  do
+    {
+      p = p ^ xtime (p);
+      q ^= q << 1;
+      q ^= q << 2;
+      q ^= q << 4;
+      if (q & 0x80)
+	q ^= 0x09;
+      sbox[p] = q ^ (uint8_t) ((q << 1) | (q >> 7))
+		^ (uint8_t) ((q << 2) | (q >> 6))
+		^ (uint8_t) ((q << 3) | (q >> 5))
+		^ (uint8_t) ((q << 4) | (q >> 4)) ^ 0x63;
+    }
+  while (p != 1);
+  sbox[0] = 0x63;
+}
+
+// Round keys in memory order, for all implementations.
+static uint8_t round_keys[176] ALIGNED;
+
+#if AES_ZVKNED
+
+#define AES_KF1(k, r) \
+  k = __riscv_vaeskf1_vi_u32m1 (k, r, 4); \
+  __riscv_vse32_v_u32m1 ((uint32_t *) (rk + 16 * (r)), k, 4)
+
+static void
+aes128_setkey (uint8_t *rk, const uint8_t *key)
+{
+  vuint32m1_t k = __riscv_vle32_v_u32m1 ((const uint32_t *) key, 4);
+
+  __riscv_vse32_v_u32m1 ((uint32_t *) rk, k, 4);
+  AES_KF1 (k, 1);
+  AES_KF1 (k, 2);
+  AES_KF1 (k, 3);
+  AES_KF1 (k, 4);
+  AES_KF1 (k, 5);
+  AES_KF1 (k, 6);
+  AES_KF1 (k, 7);
+  AES_KF1 (k, 8);
+  AES_KF1 (k, 9);
+  AES_KF1 (k, 10);
+}
+
+static void
+aes128_block (const uint8_t *rk, const uint8_t *in, uint8_t *out)
+{
+  const uint32_t *k = (const uint32_t *) rk;
+  vuint32m1_t s = __riscv_vle32_v_u32m1 ((const uint32_t *) in, 4);
+
+  s = __riscv_vxor_vv_u32m1 (s, __riscv_vle32_v_u32m1 (k, 4), 4);
+  for (int r = 1; r < 10; r++)
+    s = __riscv_vaesem_vv_u32m1 (s, __riscv_vle32_v_u32m1 (k + 4 * r, 4),
+				 4);
+  s = __riscv_vaesef_vv_u32m1 (s, __riscv_vle32_v_u32m1 (k + 40, 4), 4);
+  __riscv_vse32_v_u32m1 ((uint32_t *) out, s, 4);
+}
+
+// XOR the CTR mode key stream for IV || CTR, CTR + 1, ... into DATA, as
+// many blocks at a time as fit into a register group.
+static void
+aes128_ctr (const uint8_t *rk, const uint8_t *iv, uint32_t ctr,
+	    uint8_t *data, size_t len)
+{
+  static uint32_t blocks[BYTES / 4] ALIGNED;
+  const uint32_t *k = (const uint32_t *) rk;
+  size_t vlmax = __riscv_vsetvlmax_e32m4 ();
+
+  if (vlmax > BYTES / 4)
+    vlmax = BYTES / 4;
+  for (size_t off = 0; off < len; )
+    {
+      // A whole number of element groups, which vsetvl does not
+      // guarantee when it splits the remainder.
+      size_t n = (len - off) / 4 < vlmax ? (len - off) / 4 : vlmax;
+      size_t vl = __riscv_vsetvl_e32m4 (n);
+
+      for (size_t i = 0; i < vl; i += 4)
+	{
+	  blocks[i] = load_le32 (iv);
+	  blocks[i + 1] = load_le32 (iv + 4);
+	  blocks[i + 2] = load_le32 (iv + 8);
+	  blocks[i + 3] = __builtin_bswap32 (ctr++);
+	}
+      vuint32m4_t s = __riscv_vle32_v_u32m4 (blocks, vl);
+      s = __riscv_vaesz_vs_u32m1_u32m4 (s, __riscv_vle32_v_u32m1 (k, 4), vl);
+      for (int r = 1; r < 10; r++)
+	s = __riscv_vaesem_vs_u32m1_u32m4 (s, __riscv_vle32_v_u32m1 (k + 4 * r,
+								      4),
+					   vl);
+      s = __riscv_vaesef_vs_u32m1_u32m4 (s, __riscv_vle32_v_u32m1 (k + 40, 4),
+					 vl);
+      uint32_t *d = (uint32_t *) (data + off);
+      __riscv_vse32_v_u32m4 (d, __riscv_vxor_vv_u32m4 (
+			       __riscv_vle32_v_u32m4 (d, vl), s, vl), vl);
+      off += 4 * vl;
+    }
+}
+
+#elif AES_ZKNE
+
+#define AES_KS(r) \
+  t = aes64ks1i (k1, r); \
+  k0 = aes64ks2 (t, k0); \
+  k1 = aes64ks2 (k0, k1); \
+  store_le64 (rk + 16 * (r) + 16, k0); \
+  store_le64 (rk + 16 * (r) + 24, k1)
+
+static void
+aes128_setkey (uint8_t *rk, const uint8_t *key)
+{
+  uint64_t k0 = load_le64 (key), k1 = load_le64 (key + 8), t;
+
+  store_le64 (rk, k0);
+  store_le64 (rk + 8, k1);
+  AES_KS (0);
+  AES_KS (1);
+  AES_KS (2);
+  AES_KS (3);
+  AES_KS (4);
+  AES_KS (5);
+  AES_KS (6);
+  AES_KS (7);
+  AES_KS (8);
+  AES_KS (9);
+}
+
+static inline void
+aes128_encrypt (const uint64_t *k, uint64_t *s0, uint64_t *s1)
+{
+  uint64_t a = *s0 ^ k[0], b = *s1 ^ k[1], n0, n1;
+
+  for (int r = 1; r < 10; r++)
+    {
+      n0 = aes64esm (a, b) ^ k[2 * r];
+      n1 = aes64esm (b, a) ^ k[2 * r + 1];
+      a = n0;
+      b = n1;
+    }
+  *s0 = aes64es (a, b) ^ k[20];
+  *s1 = aes64es (b, a) ^ k[21];
+}
+
+static void
+aes128_block (const uint8_t *rk, const uint8_t *in, uint8_t *out)
+{
+  uint64_t s0 = load_le64 (in), s1 = load_le64 (in + 8);
+
+  aes128_encrypt ((const uint64_t *) rk, &s0, &s1);
+  store_le64 (out, s0);
+  store_le64 (out + 8, s1);
+}
+
+static void
+aes128_ctr (const uint8_t *rk, const uint8_t *iv, uint32_t ctr,
+	    uint8_t *data, size_t len)
+{
+  uint64_t c0 = load_le64 (iv), c1 = load_le32 (iv + 8);
+
+  for (size_t off = 0; off < len; off += 16)
+    {
+      uint64_t s0 = c0;
+      uint64_t s1 = c1 | ((uint64_t) __builtin_bswap32 (ctr++) << 32);
+
+      aes128_encrypt ((const uint64_t *) rk, &s0, &s1);
+      store_le64 (data + off, load_le64 (data + off) ^ s0);
+      store_le64 (data + off + 8, load_le64 (data + off + 8) ^ s1);
+    }
+}
+
+#else
+
+static void
+aes128_setkey (uint8_t *rk, const uint8_t *key)
+{
+  uint8_t rcon = 1;
+
+  memcpy (rk, key, 16);
+  for (int i = 16; i < 176; i += 4)
+    {
+      uint8_t t[4] = { rk[i - 4], rk[i - 3], rk[i - 2], rk[i - 1] };
+
+      if (i % 16 == 0)
+	{
+	  uint8_t t0 = t[0];
+	  t[0] = sbox[t[1]] ^ rcon;
+	  t[1] = sbox[t[2]];
+	  t[2] = sbox[t[3]];
+	  t[3] = sbox[t0];
+	  rcon = xtime (rcon);
+	}
+      for (int j = 0; j < 4; j++)
+	rk[i + j] = rk[i + j - 16] ^ t[j];
+    }
+}
+
+static void
+aes128_block (const uint8_t *rk, const uint8_t *in, uint8_t *out)
+{
+  uint8_t s[16], t[16];
+
+  for (int i = 0; i < 16; i++)
+    s[i] = in[i] ^ rk[i];
+  for (int r = 1; r <= 10; r++)
+    {
+      // SubBytes and ShiftRows; byte 4 * c + row is in column c.
+      for (int c = 0; c < 4; c++)
+	for (int row = 0; row < 4; row++)
+	  t[4 * c + row] = sbox[s[4 * ((c + row) % 4) + row]];
+      if (r < 10)
+	for (int c = 0; c < 4; c++)
+	  {
+	    uint8_t *col = &t[4 * c];
+	    uint8_t all = col[0] ^ col[1] ^ col[2] ^ col[3], c0 = col[0];
+
+	    col[0] ^= all ^ xtime (col[0] ^ col[1]);
+	    col[1] ^= all ^ xtime (col[1] ^ col[2]);
+	    col[2] ^= all ^ xtime (col[2] ^ col[3]);
+	    col[3] ^= all ^ xtime (col[3] ^ c0);
+	  }
+      for (int i = 0; i < 16; i++)
+	s[i] = t[i] ^ rk[16 * r + i];
+    }
+  memcpy (out, s, 16);
+}
+
+static void
+aes128_ctr (const uint8_t *rk, const uint8_t *iv, uint32_t ctr,
+	    uint8_t *data, size_t len)
+{
+  uint8_t block[16], ks[16];
+
+  memcpy (block, iv, 12);
+  for (size_t off = 0; off < len; off += 16)
+    {
+      store_be32 (block + 12, ctr++);
+      aes128_block (rk, block, ks);
+      for (int i = 0; i < 16; i++)
+	data[off + i] ^= ks[i];
+    }
+}
+
+#endif
+
+//--------------------------------------------------------------------------
+// GHASH: Y = (Y ^ X) * H in GF(2^128) for every 16-byte block X of DATA.
+
+#if GHASH_ZVKG
+
+static void
+ghash (uint8_t *y, const uint8_t *h, const uint8_t *data, size_t len)
+{
+  vuint32m1_t vh = __riscv_vle32_v_u32m1 ((const uint32_t *) h, 4);
+  vuint32m1_t vy = __riscv_vle32_v_u32m1 ((const uint32_t *) y, 4);
+
+  for (size_t off = 0; off < len; off += 16)
+    vy = __riscv_vghsh_vv_u32m1 (vy, vh, __riscv_vle32_v_u32m1 (
+				   (const uint32_t *) (data + off), 4), 4);
+  __riscv_vse32_v_u32m1 ((uint32_t *) y, vy, 4);
+}
+
+#elif GHASH_CLMUL
+
+// With the bits of every byte reversed, bit i of the little-endian
+// 128-bit value is the coefficient of x^i, so the product is a plain
+// carry-less multiplication, reduced by x^128 = x^7 + x^2 + x + 1.
+static void
+ghash (uint8_t *y, const uint8_t *h, const uint8_t *data, size_t len)
+{
+  uint64_t h0 = brev8 (load_le64 (h)), h1 = brev8 (load_le64 (h + 8));
+  uint64_t y0 = brev8 (load_le64 (y)), y1 = brev8 (load_le64 (y + 8));
+
+  for (size_t off = 0; off < len; off += 16)
+    {
+      uint64_t x0 = y0 ^ brev8 (load_le64 (data + off));
+      uint64_t x1 = y1 ^ brev8 (load_le64 (data + off + 8));
+      uint64_t p0 = clmul (x0, h0);
+      uint64_t p1 = clmulh (x0, h0) ^ clmul (x0, h1) ^ clmul (x1, h0);
+      uint64_t p2 = clmulh (x0, h1) ^ clmulh (x1, h0) ^ clmul (x1, h1);
+      uint64_t p3 = clmulh (x1, h1);
+
+      p1 ^= clmul (p3, 0x87);
+      p2 ^= clmulh (p3, 0x87);
+      p0 ^= clmul (p2, 0x87);
+      p1 ^= clmulh (p2, 0x87);
+      y0 = p0;
+      y1 = p1;
+    }
+  store_le64 (y, brev8 (y0));
+  store_le64 (y + 8, brev8 (y1));
+}
+
+#else
+
+static uint64_t
+load_be64 (const uint8_t *p)
+{
+  return ((uint64_t) load_be32 (p) << 32) | load_be32 (p + 4);
+}
+
+// Bit by bit, as in NIST SP 800-38D; the most significant bit of the
+// big-endian value is the coefficient of x^0.
+static void
+ghash (uint8_t *y, const uint8_t *h, const uint8_t *data, size_t len)
+{
+  uint64_t h0 = load_be64 (h), h1 = load_be64 (h + 8);
+  uint64_t y0 = load_be64 (y), y1 = load_be64 (y + 8);
+
+  for (size_t off = 0; off < len; off += 16)
+    {
+      uint64_t x0 = y0 ^ load_be64 (data + off);
+      uint64_t x1 = y1 ^ load_be64 (data + off + 8);
+      uint64_t v0 = h0, v1 = h1, z0 = 0, z1 = 0;
+
+      for (int i = 0; i < 128; i++)
+	{
+	  uint64_t bit = (i < 64 ? x0 >> (63 - i) : x1 >> (127 - i)) & 1;
+	  uint64_t carry = v1 & 1;
+
+	  z0 ^= v0 & -bit;
+	  z1 ^= v1 & -bit;
+	  v1 = (v1 >> 1) | (v0 << 63);
+	  v0 = (v0 >> 1) ^ (0xe100000000000000ull & -carry);
+	}
+      y0 = z0;
+      y1 = z1;
+    }
+  store_be32 (y, y0 >> 32);
+  store_be32 (y + 4, y0);
+  store_be32 (y + 8, y1 >> 32);
+  store_be32 (y + 12, y1);
+}
+
+#endif
+
+// AES-128-GCM encryption of BYTES bytes in place, no additional data.
+static void
+aes128_gcm_encrypt (const uint8_t *rk, const uint8_t *h, const uint8_t *iv,
+		    uint8_t *data, size_t len, uint8_t *tag)
+{
+  uint8_t y[16] ALIGNED = { 0 }, lengths[16] ALIGNED = { 0 };
+  uint8_t j0[16] ALIGNED, mask[16] ALIGNED;
+
+  aes128_ctr (rk, iv, 2, data, len);
+  ghash (y, h, data, len);
+  store_be32 (lengths + 8, (uint32_t) ((uint64_t) len >> 29));
+  store_be32 (lengths + 12, (uint32_t) (len << 3));
+  ghash (y, h, lengths, 16);
+
+  memcpy (j0, iv, 12);
+  store_be32 (j0 + 12, 1);
+  aes128_block (rk, j0, mask);
+  for (int i = 0; i < 16; i++)
+    tag[i] = y[i] ^ mask[i];
+}
+
+static uint64_t
+aes128_gcm (unsigned long iters)
+{
+  static const uint8_t key[16] ALIGNED = {
+    0xfe, 0xff, 0xe9, 0x92, 0x86, 0x65, 0x73, 0x1c,
+    0x6d, 0x6a, 0x8f, 0x94, 0x67, 0x30, 0x83, 0x08
+  };
+  uint8_t iv[12] = {
+    0xca, 0xfe, 0xba, 0xbe, 0xfa, 0xce, 0xdb, 0xad, 0xde, 0xca, 0xf8, 0x88
+  };
+  uint8_t zero[16] ALIGNED = { 0 }, h[16] ALIGNED, tag[16];
+  uint64_t sum = 0;
+
+  aes128_setkey (round_keys, key);
+  aes128_block (round_keys, zero, h);
+  for (unsigned long it = 0; it < iters; it++)
+    {
+      iv[0] = (uint8_t) it;
+      aes128_gcm_encrypt (round_keys, h, iv, buf, BYTES, tag);
+      sum = fold (sum, tag, 16);
+    }
+  return fold (sum, buf, BYTES);
+}
+
+//--------------------------------------------------------------------------
+// SHA-256
+
+static const uint32_t sha256_k[64] ALIGNED = {
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+  0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+  0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+  0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+  0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+  0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+  0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+  0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+  0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+#if SHA256_ZVKNHA
+
+// The state is kept as {f, e, b, a} and {h, g, d, c}, element 0 first,
+// which is the layout vsha2c[hl] work on.
+static void
+sha256_blocks (uint32_t *state, const uint8_t *p, size_t nblocks)
+{
+  uint32_t tmp[16] ALIGNED;
+  vbool32_t first = __riscv_vmseq_vx_u32m1_b32 (__riscv_vid_v_u32m1 (4), 0,
+						4);
+  vuint32m1_t feba, hgdc;
+
+  tmp[0] = state[5];
+  tmp[1] = state[4];
+  tmp[2] = state[1];
+  tmp[3] = state[0];
+  tmp[4] = state[7];
+  tmp[5] = state[6];
+  tmp[6] = state[3];
+  tmp[7] = state[2];
+  feba = __riscv_vle32_v_u32m1 (tmp, 4);
+  hgdc = __riscv_vle32_v_u32m1 (tmp + 4, 4);
+
+  for (; nblocks; nblocks--, p += 64)
+    {
+      vuint32m1_t feba0 = feba, hgdc0 = hgdc, w0, w1, w2, w3, kw, t;
+
+      for (int i = 0; i < 16; i++)
+	tmp[i] = load_be32 (p + 4 * i);
+      w0 = __riscv_vle32_v_u32m1 (tmp, 4);
+      w1 = __riscv_vle32_v_u32m1 (tmp + 4, 4);
+      w2 = __riscv_vle32_v_u32m1 (tmp + 8, 4);
+      w3 = __riscv_vle32_v_u32m1 (tmp + 12, 4);
+
+      // Four rounds at a time, computing the message schedule for four
+      // rounds later from {W[11], W[10], W[9], W[4]}.
+      for (int r = 0; r < 16; r++)
+	{
+	  kw = __riscv_vadd_vv_u32m1 (w0, __riscv_vle32_v_u32m1 (
+					sha256_k + 4 * r, 4), 4);
+	  hgdc = __riscv_vsha2cl_vv_u32m1 (hgdc, feba, kw, 4);
+	  feba = __riscv_vsha2ch_vv_u32m1 (feba, hgdc, kw, 4);
+	  if (r < 12)
+	    {
+	      t = __riscv_vmerge_vvm_u32m1 (w2, w1, first, 4);
+	      w0 = __riscv_vsha2ms_vv_u32m1 (w0, t, w3, 4);
+	    }
+	  t = w0;
+	  w0 = w1;
+	  w1 = w2;
+	  w2 = w3;
+	  w3 = t;
+	}
+      feba = __riscv_vadd_vv_u32m1 (feba, feba0, 4);
+      hgdc = __riscv_vadd_vv_u32m1 (hgdc, hgdc0, 4);
+    }
+
+  __riscv_vse32_v_u32m1 (tmp, feba, 4);
+  __riscv_vse32_v_u32m1 (tmp + 4, hgdc, 4);
+  state[0] = tmp[3];
+  state[1] = tmp[2];
+  state[2] = tmp[7];
+  state[3] = tmp[6];
+  state[4] = tmp[1];
+  state[5] = tmp[0];
+  state[6] = tmp[5];
+  state[7] = tmp[4];
+}
+
+#else
+
+#define ROR32(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+#if !SHA256_ZKNH
+static inline uint32_t
+sha256sig0 (uint32_t x)
+{
+  return ROR32 (x, 7) ^ ROR32 (x, 18) ^ (x >> 3);
+}
+
+static inline uint32_t
+sha256sig1 (uint32_t x)
+{
+  return ROR32 (x, 17) ^ ROR32 (x, 19) ^ (x >> 10);
+}
+
+static inline uint32_t
+sha256sum0 (uint32_t x)
+{
+  return ROR32 (x, 2) ^ ROR32 (x, 13) ^ ROR32 (x, 22);
+}
+
+static inline uint32_t
+sha256sum1 (uint32_t x)
+{
+  return ROR32 (x, 6) ^ ROR32 (x, 11) ^ ROR32 (x, 25);
+}
+#endif
+
+static void
+sha256_blocks (uint32_t *state, const uint8_t *p, size_t nblocks)
+{
+  for (; nblocks; nblocks--, p += 64)
+    {
+      uint32_t w[64], s[8];
+
+      for (int i = 0; i < 16; i++)
+	w[i] = load_be32 (p + 4 * i);
+      for (int i = 16; i < 64; i++)
+	w[i] = sha256sig1 (w[i - 2]) + w[i - 7] + sha256sig0 (w[i - 15])
+	       + w[i - 16];
+      memcpy (s, state, sizeof s);
+      for (int i = 0; i < 64; i++)
+	{
+	  uint32_t t1 = s[7] + sha256sum1 (s[4])
+			+ ((s[4] & s[5]) ^ (~s[4] & s[6])) + sha256_k[i] + w[i];
+	  uint32_t t2 = sha256sum0 (s[0])
+			+ ((s[0] & s[1]) ^ (s[0] & s[2]) ^ (s[1] & s[2]));
+	  memmove (s + 1, s, 7 * sizeof s[0]);
+	  s[4] += t1;
+	  s[0] = t1 + t2;
+	}
+      for (int i = 0; i < 8; i++)
+	state[i] += s[i];
+    }
+}
+
+#endif
+
+static void
+sha256 (const uint8_t *p, size_t len, uint8_t *digest)
+{
+  uint32_t state[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+  };
+  uint8_t tail[128] = { 0 };
+  size_t full = len / 64, rest = len % 64, padded;
+
+  sha256_blocks (state, p, full);
+  memcpy (tail, p + 64 * full, rest);
+  tail[rest] = 0x80;
+  padded = rest < 56 ? 64 : 128;
+  store_be32 (tail + padded - 8, (uint32_t) ((uint64_t) len >> 29));
+  store_be32 (tail + padded - 4, (uint32_t) (len << 3));
+  sha256_blocks (state, tail, padded / 64);
+  for (int i = 0; i < 8; i++)
+    store_be32 (digest + 4 * i, state[i]);
+}
+
+static uint64_t
+sha256_kernel (unsigned long iters)
+{
+  uint8_t digest[32];
+  uint64_t sum = 0;
+
+  for (unsigned long it = 0; it < iters; it++)
+    {
+      buf[0] = (uint8_t) it;
+      sha256 (buf, BYTES, digest);
+      sum = fold (sum, digest, 32);
+    }
+  return sum;
+}
+
+//--------------------------------------------------------------------------
+// ChaCha20 (RFC 8439)
+
+static const uint32_t chacha20_key[8] = {
+  0x03020100, 0x07060504, 0x0b0a0908, 0x0f0e0d0c,
+  0x13121110, 0x17161514, 0x1b1a1918, 0x1f1e1d1c
+};
+
+#if CHACHA20_V
+
+#ifdef __riscv_zvkb
+#define ROTV(v, n) __riscv_vrol_vx_u32m1 (v, n, vl)
+#else
+#define ROTV(v, n) __riscv_vor_vv_u32m1 (__riscv_vsll_vx_u32m1 (v, n, vl), \
+					 __riscv_vsrl_vx_u32m1 (v, 32 - (n), \
+								vl), vl)
+#endif
+
+#define QRV(a, b, c, d) \
+  a = __riscv_vadd_vv_u32m1 (a, b, vl); \
+  d = ROTV (__riscv_vxor_vv_u32m1 (d, a, vl), 16); \
+  c = __riscv_vadd_vv_u32m1 (c, d, vl); \
+  b = ROTV (__riscv_vxor_vv_u32m1 (b, c, vl), 12); \
+  a = __riscv_vadd_vv_u32m1 (a, b, vl); \
+  d = ROTV (__riscv_vxor_vv_u32m1 (d, a, vl), 8); \
+  c = __riscv_vadd_vv_u32m1 (c, d, vl); \
+  b = ROTV (__riscv_vxor_vv_u32m1 (b, c, vl), 7)
+
+// XOR key stream word I of every block in the register group into DATA;
+// the blocks are processed side by side, one per element.
+#define XOR_WORD(i, ks) do \
+  { \
+    uint32_t *__p = (uint32_t *) (data + 64 * blk) + (i); \
+    vuint32m1_t __v = __riscv_vlse32_v_u32m1 (__p, 64, vl); \
+    __v = __riscv_vxor_vv_u32m1 (__v, ks, vl); \
+    __riscv_vsse32_v_u32m1 (__p, 64, __v, vl); \
+  } while (0)
+#define XOR_STATE_WORD(i, x) XOR_WORD (i, __riscv_vadd_vx_u32m1 (x, in[i], vl))
+
+static void
+chacha20_xor (const uint32_t *nonce, uint32_t ctr, uint8_t *data,
+	      size_t len)
+{
+  const uint32_t in[16] = {
+    0x61707865, 0x3320646e, 0x79622d32, 0x6b206574,
+    chacha20_key[0], chacha20_key[1], chacha20_key[2], chacha20_key[3],
+    chacha20_key[4], chacha20_key[5], chacha20_key[6], chacha20_key[7],
+    0, nonce[0], nonce[1], nonce[2]
+  };
+
+  for (size_t blk = 0, vl; blk < len / 64; blk += vl)
+    {
+      vl = __riscv_vsetvl_e32m1 (len / 64 - blk);
+      vuint32m1_t ctrv = __riscv_vadd_vx_u32m1 (__riscv_vid_v_u32m1 (vl),
+						ctr + blk, vl);
+      vuint32m1_t x0 = __riscv_vmv_v_x_u32m1 (in[0], vl);
+      vuint32m1_t x1 = __riscv_vmv_v_x_u32m1 (in[1], vl);
+      vuint32m1_t x2 = __riscv_vmv_v_x_u32m1 (in[2], vl);
+      vuint32m1_t x3 = __riscv_vmv_v_x_u32m1 (in[3], vl);
+      vuint32m1_t x4 = __riscv_vmv_v_x_u32m1 (in[4], vl);
+      vuint32m1_t x5 = __riscv_vmv_v_x_u32m1 (in[5], vl);
+      vuint32m1_t x6 = __riscv_vmv_v_x_u32m1 (in[6], vl);
+      vuint32m1_t x7 = __riscv_vmv_v_x_u32m1 (in[7], vl);
+      vuint32m1_t x8 = __riscv_vmv_v_x_u32m1 (in[8], vl);
+      vuint32m1_t x9 = __riscv_vmv_v_x_u32m1 (in[9], vl);
+      vuint32m1_t x10 = __riscv_vmv_v_x_u32m1 (in[10], vl);
+      vuint32m1_t x11 = __riscv_vmv_v_x_u32m1 (in[11], vl);
+      vuint32m1_t x12 = ctrv;
+      vuint32m1_t x13 = __riscv_vmv_v_x_u32m1 (in[13], vl);
+      vuint32m1_t x14 = __riscv_vmv_v_x_u32m1 (in[14], vl);
+      vuint32m1_t x15 = __riscv_vmv_v_x_u32m1 (in[15], vl);
+
+      for (int r = 0; r < 10; r++)
+	{
+	  QRV (x0, x4, x8, x12);
+	  QRV (x1, x5, x9, x13);
+	  QRV (x2, x6, x10, x14);
+	  QRV (x3, x7, x11, x15);
+	  QRV (x0, x5, x10, x15);
+	  QRV (x1, x6, x11, x12);
+	  QRV (x2, x7, x8, x13);
+	  QRV (x3, x4, x9, x14);
+	}
+
+      XOR_STATE_WORD (0, x0);
+      XOR_STATE_WORD (1, x1);
+      XOR_STATE_WORD (2, x2);
+      XOR_STATE_WORD (3, x3);
+      XOR_STATE_WORD (4, x4);
+      XOR_STATE_WORD (5, x5);
+      XOR_STATE_WORD (6, x6);
+      XOR_STATE_WORD (7, x7);
+      XOR_STATE_WORD (8, x8);
+      XOR_STATE_WORD (9, x9);
+      XOR_STATE_WORD (10, x10);
+      XOR_STATE_WORD (11, x11);
+      XOR_WORD (12, __riscv_vadd_vv_u32m1 (x12, ctrv, vl));
+      XOR_STATE_WORD (13, x13);
+      XOR_STATE_WORD (14, x14);
+      XOR_STATE_WORD (15, x15);
+    }
+}
+
+#else
+
+#define ROTL32(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+
+#define QR(a, b, c, d) \
+  a += b; d = ROTL32 (d ^ a, 16); \
+  c += d; b = ROTL32 (b ^ c, 12); \
+  a += b; d = ROTL32 (d ^ a, 8); \
+  c += d; b = ROTL32 (b ^ c, 7)
+
+static void
+chacha20_xor (const uint32_t *nonce, uint32_t ctr, uint8_t *data,
+	      size_t len)
+{
+  uint32_t in[16] = {
+    0x61707865, 0x3320646e, 0x79622d32, 0x6b206574,
+    chacha20_key[0], chacha20_key[1], chacha20_key[2], chacha20_key[3],
+    chacha20_key[4], chacha20_key[5], chacha20_key[6], chacha20_key[7],
+    0, nonce[0], nonce[1], nonce[2]
+  };
+
+  for (size_t off = 0; off < len; off += 64)
+    {
+      uint32_t x[16];
+
+      in[12] = ctr++;
+      memcpy (x, in, sizeof x);
+      for (int r = 0; r < 10; r++)
+	{
+	  QR (x[0], x[4], x[8], x[12]);
+	  QR (x[1], x[5], x[9], x[13]);
+	  QR (x[2], x[6], x[10], x[14]);
+	  QR (x[3], x[7], x[11], x[15]);
+	  QR (x[0], x[5], x[10], x[15]);
+	  QR (x[1], x[6], x[11], x[12]);
+	  QR (x[2], x[7], x[8], x[13]);
+	  QR (x[3], x[4], x[9], x[14]);
+	}
+      for (int i = 0; i < 16; i++)
+	{
+	  uint32_t k = x[i] + in[i];
+
+	  data[off + 4 * i] ^= k;
+	  data[off + 4 * i + 1] ^= k >> 8;
+	  data[off + 4 * i + 2] ^= k >> 16;
+	  data[off + 4 * i + 3] ^= k >> 24;
+	}
+    }
+}
+
+#endif
+
+static uint64_t
+chacha20 (unsigned long iters)
+{
+  uint32_t nonce[3] = { 0, 0x4a000000, 0 };
+
+  for (unsigned long it = 0; it < iters; it++)
+    {
+      nonce[0] = (uint32_t) it;
+      chacha20_xor (nonce, 1, buf, BYTES);
+    }
+  return fold (0, buf, BYTES);
+}
+
+static const struct
+{
+  const char *name;
+  const char *impl;
+  uint64_t (*run) (unsigned long);
+} kernels[] = {
+  { "aes128_gcm", AES_IMPL "+" GHASH_IMPL, aes128_gcm },
+  { "sha256", SHA256_IMPL, sha256_kernel },
+  { "chacha20", CHACHA20_IMPL, chacha20 },
+};
+
+#define KERNEL_COUNT (sizeof (kernels) / sizeof (kernels[0]))
+
+int
+main (int argc, char **argv)
+{
+  size_t i;
+
+  if (argc < 3)
+    {
+      for (i = 0; i < KERNEL_COUNT; i++)
+	printf ("%s %d %s\n", kernels[i].name, BYTES, kernels[i].impl);
+      return 0;
+    }
+
+  aes_init ();
+  for (i = 0; i < BYTES; i++)
+    buf[i] = (uint8_t) (i * 7);
+
+  for (i = 0; i < KERNEL_COUNT; i++)
+    if (strcmp (kernels[i].name, argv[1]) == 0)
+      {
+	uint64_t sum = kernels[i].run (strtoul (argv[2], NULL, 0));
+	printf ("%s %016llx\n", argv[1], (unsigned long long) sum);
+	return 0;
+      }
+
+  fprintf (stderr, "unknown kernel %s\n", argv[1]);
+  return 1;
+}
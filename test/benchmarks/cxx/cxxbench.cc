@@ -0,0 +1,198 @@
+// See LICENSE for license details.
+
+//**************************************************************************
+// C++ runtime and STL benchmark
+//--------------------------------------------------------------------------
+//
+// Usage: cxxbench <kernel> <iterations>, or no arguments to list the
+// kernels.  Setup happens outside the timed loop so a run with zero
+// iterations measures everything but the kernel itself.
+//
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+volatile unsigned long sink;
+
+unsigned
+next_rand (unsigned &state)
+{
+  state = state * 1103515245u + 12345u;
+  return state >> 8;
+}
+
+void
+vector_growth (unsigned iters)
+{
+  for (unsigned i = 0; i < iters; i++)
+    {
+      std::vector<int> v;
+      for (int j = 0; j < 1024; j++)
+	v.push_back (j);
+      sink += v.size () + v.capacity ();
+    }
+}
+
+void
+unordered_map_insert (unsigned iters)
+{
+  for (unsigned i = 0; i < iters; i++)
+    {
+      std::unordered_map<unsigned, unsigned> m;
+      unsigned state = i;
+      for (int j = 0; j < 256; j++)
+	m[next_rand (state)] = j;
+      sink += m.size ();
+    }
+}
+
+std::unordered_map<unsigned, unsigned> lookup_map;
+std::vector<unsigned> lookup_keys;
+
+void
+unordered_map_lookup_setup ()
+{
+  unsigned state = 1;
+  for (int j = 0; j < 4096; j++)
+    {
+      unsigned key = next_rand (state);
+      lookup_map[key] = j;
+      lookup_keys.push_back (j & 1 ? key : key + 1);
+    }
+}
+
+void
+unordered_map_lookup (unsigned iters)
+{
+  for (unsigned i = 0; i < iters; i++)
+    for (unsigned key : lookup_keys)
+      {
+	auto it = lookup_map.find (key);
+	if (it != lookup_map.end ())
+	  sink += it->second;
+      }
+}
+
+std::vector<unsigned> sort_input;
+
+void
+sort_setup ()
+{
+  unsigned state = 7;
+  for (int j = 0; j < 1024; j++)
+    sort_input.push_back (next_rand (state));
+}
+
+void
+sort (unsigned iters)
+{
+  std::vector<unsigned> v;
+  for (unsigned i = 0; i < iters; i++)
+    {
+      v = sort_input;
+      std::sort (v.begin (), v.end ());
+      sink += v[i % v.size ()];
+    }
+}
+
+void
+string_sso (unsigned iters)
+{
+  static const char *const words[] = { "a", "risc", "vector", "toolchain" };
+  for (unsigned i = 0; i < iters; i++)
+    {
+      std::string s (words[i & 3]);
+      std::string t = s;
+      t += "-x";
+      t.append (words[(i + 1) & 3]);
+      std::string u = t.substr (1, 5);
+      sink += u.size () + (s < t) + t.find ('-');
+    }
+}
+
+void
+iostream_format (unsigned iters)
+{
+  for (unsigned i = 0; i < iters; i++)
+    {
+      std::ostringstream os;
+      os << "iter " << i << ' ' << 3.25 * i << ' ' << std::hex << i;
+      sink += os.str ().size ();
+    }
+}
+
+__attribute__ ((noinline)) void
+thrower (unsigned depth)
+{
+  if (depth == 0)
+    throw std::runtime_error ("unwind");
+  thrower (depth - 1);
+  sink++;
+}
+
+void
+exception_throw (unsigned iters)
+{
+  for (unsigned i = 0; i < iters; i++)
+    {
+      try
+	{
+	  thrower (4);
+	}
+      catch (const std::exception &e)
+	{
+	  sink += e.what ()[0];
+	}
+    }
+}
+
+struct kernel
+{
+  const char *name;
+  void (*setup) ();
+  void (*run) (unsigned);
+};
+
+const kernel kernels[] = {
+  { "vector_growth", nullptr, vector_growth },
+  { "unordered_map_insert", nullptr, unordered_map_insert },
+  { "unordered_map_lookup", unordered_map_lookup_setup, unordered_map_lookup },
+  { "sort", sort_setup, sort },
+  { "string_sso", nullptr, string_sso },
+  { "iostream_format", nullptr, iostream_format },
+  { "exception_throw", nullptr, exception_throw },
+};
+
+} // anonymous namespace
+
+int
+main (int argc, char **argv)
+{
+  if (argc < 3)
+    {
+      for (const kernel &k : kernels)
+	std::printf ("%s\n", k.name);
+      return 0;
+    }
+
+  for (const kernel &k : kernels)
+    if (std::strcmp (k.name, argv[1]) == 0)
+      {
+	if (k.setup)
+	  k.setup ();
+	k.run (std::strtoul (argv[2], nullptr, 0));
+	return 0;
+      }
+
+  std::fprintf (stderr, "unknown kernel %s\n", argv[1]);
+  return 1;
+}
@@ -9,9 +9,7 @@
 
 struct tms      time_info;
 
-#define read_csr(reg) ({ unsigned long __tmp; \
-  asm volatile ("csrr %0, " #reg : "=r"(__tmp)); \
-  __tmp; })
+#include "bench.h"
 
 #pragma GCC optimize ("no-inline")
 
@@ -53,6 +51,7 @@ long            Begin_Time,
                 User_Time;
 long            Microseconds,
                 Dhrystones_Per_Second;
+bench_region_t  Region;
 
 /* end of variables for time measurement */
 
@@ -115,6 +114,7 @@ int main (int argc, char** argv)
     /* Start timer */
     /***************/
 
+    bench_begin (&Region);
     Start_Timer();
 
     for (Run_Index = 1; Run_Index <= Number_Of_Runs; ++Run_Index)
@@ -168,6 +168,7 @@ int main (int argc, char** argv)
     /**************/
 
     Stop_Timer();
+    bench_end (&Region);
 
     User_Time = End_Time - Begin_Time;
 
@@ -236,6 +237,7 @@ int main (int argc, char** argv)
 
   printf("Microseconds for one run through Dhrystone: %ld\n", Microseconds);
   printf("Dhrystones per Second:                      %ld\n", Dhrystones_Per_Second);
+  bench_report ("dhrystone", &Region, Number_Of_Runs);
 
   return 0;
 }
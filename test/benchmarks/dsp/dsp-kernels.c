@@ -0,0 +1,177 @@
+// See LICENSE for license details.
+
+//**************************************************************************
+// Floating-point DSP kernels
+//--------------------------------------------------------------------------
+//
+// Usage: dsp-kernels <kernel> <iterations>, or no arguments to list the
+// kernels.  FIR filter, complex FFT, matrix multiply and biquad IIR
+// kernels are built from dsp-template.h in double (f64), single (f32) and,
+// when the compiler has _Float16, half (f16) precision.  Every kernel
+// prints the sum of its outputs.  Half precision arithmetic is evaluated
+// in single precision unless Zfh or Zhinx is available, so only the f32
+// and f64 results are exactly the same for every -march.
+//
+// By default every kernel is linked in.  Building with -DONLY_KERNEL and
+// -DONLY_<kernel> links in just that kernel (and -DONLY_KERNEL alone
+// none), which lets the harness attribute code size to each kernel,
+// including the soft-float support routines it pulls in.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef ONLY_KERNEL
+#define ALL_KERNELS
+#endif
+
+#define SIGNAL_N 1021
+#define FIR_N 1024
+#define FIR_TAPS 32
+#define FFT_N 256
+#define MM_N 32
+#define IIR_N 1024
+#define IIR_SECTIONS 4
+
+static double signal[SIGNAL_N];
+static double taps[FIR_TAPS];
+static double twiddle_re[FFT_N / 2], twiddle_im[FFT_N / 2];
+static unsigned short fft_rev[FFT_N];
+
+// A second-order Butterworth low pass at a tenth of the sample rate.
+static const double biquad_b0 = 0.0674552738890719;
+static const double biquad_b1 = 0.1349105477781438;
+static const double biquad_b2 = 0.0674552738890719;
+static const double biquad_a1 = -1.1429805025399011;
+static const double biquad_a2 = 0.4128015980961887;
+
+static void
+init (void)
+{
+  unsigned int seed = 12345;
+
+  for (size_t i = 0; i < SIGNAL_N; i++)
+    {
+      seed = seed * 1103515245 + 12345;
+      signal[i] = (double) (seed >> 8) / (1 << 23) - 1.0;
+    }
+  for (size_t i = 0; i < FIR_TAPS; i++)
+    taps[i] = (double) (i < FIR_TAPS / 2 ? i + 1 : FIR_TAPS - i)
+	      / (FIR_TAPS * FIR_TAPS / 4);
+
+  // exp(-2 pi i k / FFT_N) by repeated multiplication, without libm.
+  twiddle_re[0] = 1.0;
+  twiddle_im[0] = 0.0;
+  for (size_t k = 1; k < FFT_N / 2; k++)
+    {
+      const double c = 0.99969881869620425, s = -0.024541228522912288;
+
+      twiddle_re[k] = twiddle_re[k - 1] * c - twiddle_im[k - 1] * s;
+      twiddle_im[k] = twiddle_re[k - 1] * s + twiddle_im[k - 1] * c;
+    }
+  for (size_t i = 0; i < FFT_N; i++)
+    {
+      unsigned rev = 0;
+      for (size_t bit = 1; bit < FFT_N; bit <<= 1)
+	rev = (rev << 1) | ((i & bit) != 0);
+      fft_rev[i] = rev;
+    }
+}
+
+#define T double
+#define S f64
+#include "dsp-template.h"
+#undef T
+#undef S
+
+#define T float
+#define S f32
+#include "dsp-template.h"
+#undef T
+#undef S
+
+#ifdef __FLT16_MAX__
+#define T _Float16
+#define S f16
+#include "dsp-template.h"
+#undef T
+#undef S
+#endif
+
+static const struct
+{
+  const char *name;
+  double (*run) (unsigned long);
+} kernels[] = {
+#if defined (ALL_KERNELS) || defined (ONLY_fir_f64)
+  { "fir_f64", fir_f64 },
+#endif
+#if defined (ALL_KERNELS) || defined (ONLY_fir_f32)
+  { "fir_f32", fir_f32 },
+#endif
+#if defined (__FLT16_MAX__) && (defined (ALL_KERNELS) || defined (ONLY_fir_f16))
+  { "fir_f16", fir_f16 },
+#endif
+#if defined (ALL_KERNELS) || defined (ONLY_fft_f64)
+  { "fft_f64", fft_f64 },
+#endif
+#if defined (ALL_KERNELS) || defined (ONLY_fft_f32)
+  { "fft_f32", fft_f32 },
+#endif
+#if defined (__FLT16_MAX__) && (defined (ALL_KERNELS) || defined (ONLY_fft_f16))
+  { "fft_f16", fft_f16 },
+#endif
+#if defined (ALL_KERNELS) || defined (ONLY_matmul_f64)
+  { "matmul_f64", matmul_f64 },
+#endif
+#if defined (ALL_KERNELS) || defined (ONLY_matmul_f32)
+  { "matmul_f32", matmul_f32 },
+#endif
+#if defined (__FLT16_MAX__) \
+    && (defined (ALL_KERNELS) || defined (ONLY_matmul_f16))
+  { "matmul_f16", matmul_f16 },
+#endif
+#if defined (ALL_KERNELS) || defined (ONLY_biquad_f64)
+  { "biquad_f64", biquad_f64 },
+#endif
+#if defined (ALL_KERNELS) || defined (ONLY_biquad_f32)
+  { "biquad_f32", biquad_f32 },
+#endif
+#if defined (__FLT16_MAX__) \
+    && (defined (ALL_KERNELS) || defined (ONLY_biquad_f16))
+  { "biquad_f16", biquad_f16 },
+#endif
+  { NULL, NULL }
+};
+
+int
+main (int argc, char **argv)
+{
+  size_t i;
+
+  if (argc < 3)
+    {
+      for (i = 0; kernels[i].name; i++)
+	printf ("%s\n", kernels[i].name);
+      return 0;
+    }
+
+  init ();
+  init_f64 ();
+  init_f32 ();
+#ifdef __FLT16_MAX__
+  init_f16 ();
+#endif
+
+  for (i = 0; kernels[i].name; i++)
+    if (strcmp (kernels[i].name, argv[1]) == 0)
+      {
+	double sum = kernels[i].run (strtoul (argv[2], NULL, 0));
+	printf ("%s %.17g\n", argv[1], sum);
+	return 0;
+      }
+
+  fprintf (stderr, "unknown kernel %s\n", argv[1]);
+  return 1;
+}
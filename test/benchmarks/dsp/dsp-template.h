@@ -0,0 +1,154 @@
+// See LICENSE for license details.
+
+//**************************************************************************
+// DSP kernels for one floating-point type
+//--------------------------------------------------------------------------
+//
+// Included by dsp-kernels.c once per type with T defined to the type and
+// S to the suffix of the kernel names.  The inputs are set up by
+// init_<S> from the double precision data in dsp-kernels.c.
+//
+
+#define DSP_CAT2(a, b) a##_##b
+#define DSP_CAT(a, b) DSP_CAT2 (a, b)
+#define DSP_NAME(name) DSP_CAT (name, S)
+
+static T DSP_NAME (fir_x)[FIR_N + FIR_TAPS];
+static T DSP_NAME (fir_h)[FIR_TAPS];
+static T DSP_NAME (fir_y)[FIR_N];
+static T DSP_NAME (fft_in)[2 * FFT_N];
+static T DSP_NAME (fft_re)[FFT_N], DSP_NAME (fft_im)[FFT_N];
+static T DSP_NAME (fft_wr)[FFT_N / 2], DSP_NAME (fft_wi)[FFT_N / 2];
+static T DSP_NAME (mm_a)[MM_N][MM_N], DSP_NAME (mm_b)[MM_N][MM_N];
+static T DSP_NAME (mm_c)[MM_N][MM_N];
+static T DSP_NAME (iir_x)[IIR_N], DSP_NAME (iir_y)[IIR_N];
+
+static void
+DSP_NAME (init) (void)
+{
+  for (size_t i = 0; i < FIR_N + FIR_TAPS; i++)
+    DSP_NAME (fir_x)[i] = (T) signal[i % SIGNAL_N];
+  for (size_t i = 0; i < FIR_TAPS; i++)
+    DSP_NAME (fir_h)[i] = (T) taps[i];
+  for (size_t i = 0; i < 2 * FFT_N; i++)
+    DSP_NAME (fft_in)[i] = (T) signal[i % SIGNAL_N];
+  for (size_t i = 0; i < FFT_N / 2; i++)
+    {
+      DSP_NAME (fft_wr)[i] = (T) twiddle_re[i];
+      DSP_NAME (fft_wi)[i] = (T) twiddle_im[i];
+    }
+  for (size_t i = 0; i < MM_N; i++)
+    for (size_t j = 0; j < MM_N; j++)
+      {
+	DSP_NAME (mm_a)[i][j] = (T) signal[(i * MM_N + j) % SIGNAL_N];
+	DSP_NAME (mm_b)[i][j] = (T) signal[(j * MM_N + i + 7) % SIGNAL_N];
+      }
+  for (size_t i = 0; i < IIR_N; i++)
+    DSP_NAME (iir_x)[i] = (T) signal[i % SIGNAL_N];
+}
+
+static double
+DSP_NAME (sum) (const T *p, size_t n)
+{
+  double sum = 0;
+  for (size_t i = 0; i < n; i++)
+    sum += (double) p[i];
+  return sum;
+}
+
+static double
+DSP_NAME (fir) (unsigned long iters)
+{
+  const T *x = DSP_NAME (fir_x), *h = DSP_NAME (fir_h);
+  T *y = DSP_NAME (fir_y);
+
+  for (unsigned long it = 0; it < iters; it++)
+    for (size_t i = 0; i < FIR_N; i++)
+      {
+	T acc = 0;
+	for (size_t k = 0; k < FIR_TAPS; k++)
+	  acc += h[k] * x[i + k];
+	y[i] = acc;
+      }
+  return DSP_NAME (sum) (y, FIR_N);
+}
+
+// Radix-2 decimation-in-time complex FFT, in place after a bit-reversed
+// copy of the input.
+static double
+DSP_NAME (fft) (unsigned long iters)
+{
+  T *re = DSP_NAME (fft_re), *im = DSP_NAME (fft_im);
+  const T *wr = DSP_NAME (fft_wr), *wi = DSP_NAME (fft_wi);
+
+  for (unsigned long it = 0; it < iters; it++)
+    {
+      for (size_t i = 0; i < FFT_N; i++)
+	{
+	  re[fft_rev[i]] = DSP_NAME (fft_in)[2 * i];
+	  im[fft_rev[i]] = DSP_NAME (fft_in)[2 * i + 1];
+	}
+      for (size_t len = 2; len <= FFT_N; len *= 2)
+	for (size_t i = 0; i < FFT_N; i += len)
+	  for (size_t j = 0; j < len / 2; j++)
+	    {
+	      size_t w = j * (FFT_N / len);
+	      size_t a = i + j, b = i + j + len / 2;
+	      T tr = re[b] * wr[w] - im[b] * wi[w];
+	      T ti = re[b] * wi[w] + im[b] * wr[w];
+
+	      re[b] = re[a] - tr;
+	      im[b] = im[a] - ti;
+	      re[a] += tr;
+	      im[a] += ti;
+	    }
+    }
+  return DSP_NAME (sum) (re, FFT_N) + 3 * DSP_NAME (sum) (im, FFT_N);
+}
+
+static double
+DSP_NAME (matmul) (unsigned long iters)
+{
+  for (unsigned long it = 0; it < iters; it++)
+    for (size_t i = 0; i < MM_N; i++)
+      for (size_t j = 0; j < MM_N; j++)
+	{
+	  T acc = 0;
+	  for (size_t k = 0; k < MM_N; k++)
+	    acc += DSP_NAME (mm_a)[i][k] * DSP_NAME (mm_b)[k][j];
+	  DSP_NAME (mm_c)[i][j] = acc;
+	}
+  return DSP_NAME (sum) (&DSP_NAME (mm_c)[0][0], MM_N * MM_N);
+}
+
+// A cascade of IIR_SECTIONS biquads in transposed direct form II.
+static double
+DSP_NAME (biquad) (unsigned long iters)
+{
+  const T *x = DSP_NAME (iir_x);
+  T *y = DSP_NAME (iir_y);
+
+  for (unsigned long it = 0; it < iters; it++)
+    {
+      T z1[IIR_SECTIONS] = { 0 }, z2[IIR_SECTIONS] = { 0 };
+
+      for (size_t i = 0; i < IIR_N; i++)
+	{
+	  T v = x[i];
+	  for (size_t s = 0; s < IIR_SECTIONS; s++)
+	    {
+	      T out = (T) biquad_b0 * v + z1[s];
+
+	      z1[s] = (T) biquad_b1 * v - (T) biquad_a1 * out + z2[s];
+	      z2[s] = (T) biquad_b2 * v - (T) biquad_a2 * out;
+	      v = out;
+	    }
+	  y[i] = v;
+	}
+    }
+  return DSP_NAME (sum) (y, IIR_N);
+}
+
+#undef DSP_NAME
+#undef DSP_CAT
+#undef DSP_CAT2
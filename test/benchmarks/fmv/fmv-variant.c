@@ -0,0 +1,21 @@
+// See LICENSE for license details.
+
+//**************************************************************************
+// Function multiversioning benchmark: one variant
+//--------------------------------------------------------------------------
+//
+// Built once per variant with -DVARIANT=<name> and the -march of that
+// variant, which defines fmv_sum_<name>.
+//
+
+#include "fmv.h"
+
+#define FMV_CAT2(a, b) a##_##b
+#define FMV_CAT(a, b) FMV_CAT2 (a, b)
+
+uint64_t
+FMV_CAT (fmv_sum, VARIANT) (const uint32_t *idx, const uint64_t *tab,
+			    size_t n)
+{
+  return fmv_sum_body (idx, tab, n);
+}
@@ -0,0 +1,196 @@
+// See LICENSE for license details.
+
+//**************************************************************************
+// Function multiversioning benchmark
+//--------------------------------------------------------------------------
+//
+// Usage: fmv <kernel> <iterations>, fmv variant to print the variant of
+// fmv_sum that was picked, or no arguments to list the kernels.
+//
+// fmv_sum is one of three builds of fmv_sum_body (base, zba_zbb and v),
+// selected in one of three ways:
+//
+//   default            an ifunc whose resolver queries the extensions of
+//                      the CPU with __riscv_hwprobe, as glibc passes it to
+//                      the IRELATIVE resolvers of RISC-V since 2.40.
+//   FMV_DIRECT=<name>  a direct call to fmv_sum_<name>, the baseline for
+//                      the cost of the dispatch.
+//   FMV_TARGET_CLONES  GCC's target_clones attribute, which generates the
+//                      clones and the resolver itself.  The picked clone
+//                      is only known from the symbol of the code that
+//                      runs, e.g. in QEMU's in_asm log.
+//
+// The resolver kernel calls the ifunc resolver directly, including the
+// hwprobe system call, to measure the cost of one resolution.  glibc
+// only; musl does not support ifunc.
+//
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fmv.h"
+
+#define N 1024
+
+#define FMV_CAT2(a, b) a##_##b
+#define FMV_CAT(a, b) FMV_CAT2 (a, b)
+#define FMV_STR2(a) #a
+#define FMV_STR(a) FMV_STR2 (a)
+
+static uint32_t idx[N];
+static uint64_t tab[N];
+
+#if defined (FMV_DIRECT)
+
+#define fmv_sum FMV_CAT (fmv_sum, FMV_DIRECT)
+
+static void
+print_variant (void)
+{
+  printf ("%s\n", FMV_STR (FMV_DIRECT));
+}
+
+#elif defined (FMV_TARGET_CLONES)
+
+__attribute__ ((target_clones ("default", "arch=+zba,+zbb", "arch=+v")))
+uint64_t
+fmv_sum (const uint32_t *idx, const uint64_t *tab, size_t n)
+{
+  return fmv_sum_body (idx, tab, n);
+}
+
+static void
+print_variant (void)
+{
+  printf ("clones\n");
+}
+
+#else
+
+#include <sys/auxv.h>
+#include <sys/hwprobe.h>
+
+static const char *fmv_variant = "none";
+static unsigned long resolver_calls;
+
+static fmv_sum_t
+resolve_fmv_sum (uint64_t hwcap, __riscv_hwprobe_t hwprobe, void *arg)
+{
+  struct riscv_hwprobe pair = { RISCV_HWPROBE_KEY_IMA_EXT_0, 0 };
+  const uint64_t zba_zbb = RISCV_HWPROBE_EXT_ZBA | RISCV_HWPROBE_EXT_ZBB;
+
+  (void) hwcap;
+  (void) arg;
+  resolver_calls++;
+  if (hwprobe (&pair, 1, 0, NULL, 0) != 0 || pair.key < 0)
+    pair.value = 0;
+
+  if (pair.value & RISCV_HWPROBE_IMA_V)
+    {
+      fmv_variant = "v";
+      return fmv_sum_v;
+    }
+  if ((pair.value & zba_zbb) == zba_zbb)
+    {
+      fmv_variant = "zba_zbb";
+      return fmv_sum_zba_zbb;
+    }
+  fmv_variant = "base";
+  return fmv_sum_base;
+}
+
+uint64_t fmv_sum (const uint32_t *, const uint64_t *, size_t)
+  __attribute__ ((ifunc ("resolve_fmv_sum")));
+
+/* The variant is only known once the IRELATIVE relocation was processed,
+   which happens before main with static linking and immediate binding.  */
+static void
+print_variant (void)
+{
+  printf ("%s %lu\n", fmv_variant, resolver_calls);
+}
+
+static uint64_t
+resolver (unsigned long iters)
+{
+  uint64_t sum = 0;
+
+  for (unsigned long it = 0; it < iters; it++)
+    sum += resolve_fmv_sum (getauxval (AT_HWCAP), __riscv_hwprobe, NULL)
+	   != NULL;
+  return sum;
+}
+
+#endif
+
+// The whole table per call, to compare the variants.
+static uint64_t
+sum (unsigned long iters)
+{
+  uint64_t s = 0;
+
+  for (unsigned long it = 0; it < iters; it++)
+    s += fmv_sum (idx, tab, N);
+  return s;
+}
+
+// One element per call, so the dispatch dominates.
+static uint64_t
+call (unsigned long iters)
+{
+  uint64_t s = 0;
+
+  for (unsigned long it = 0; it < iters * N; it++)
+    s += fmv_sum (idx + it % N, tab, 1);
+  return s;
+}
+
+static const struct
+{
+  const char *name;
+  uint64_t (*run) (unsigned long);
+} kernels[] = {
+  { "sum", sum },
+  { "call", call },
+#if !defined (FMV_DIRECT) && !defined (FMV_TARGET_CLONES)
+  { "resolver", resolver },
+#endif
+};
+
+#define KERNEL_COUNT (sizeof (kernels) / sizeof (kernels[0]))
+
+int
+main (int argc, char **argv)
+{
+  size_t i;
+
+  if (argc == 2 && strcmp (argv[1], "variant") == 0)
+    {
+      print_variant ();
+      return 0;
+    }
+  if (argc < 3)
+    {
+      for (i = 0; i < KERNEL_COUNT; i++)
+	printf ("%s\n", kernels[i].name);
+      return 0;
+    }
+
+  for (i = 0; i < N; i++)
+    {
+      idx[i] = (uint32_t) ((i * 97) % N);
+      tab[i] = (uint64_t) i * 0x9e3779b97f4a7c15ull;
+    }
+
+  for (i = 0; i < KERNEL_COUNT; i++)
+    if (strcmp (kernels[i].name, argv[1]) == 0)
+      {
+	uint64_t s = kernels[i].run (strtoul (argv[2], NULL, 0));
+	printf ("%s %016llx\n", argv[1], (unsigned long long) s);
+	return 0;
+      }
+
+  fprintf (stderr, "unknown kernel %s\n", argv[1]);
+  return 1;
+}
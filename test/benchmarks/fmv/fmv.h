@@ -0,0 +1,35 @@
+// See LICENSE for license details.
+
+//**************************************************************************
+// Function multiversioning benchmark: the multiversioned function
+//--------------------------------------------------------------------------
+//
+// fmv_sum_body is compiled once per variant, with the -march of that
+// variant (fmv-variant.c) or as the body of every target_clones clone
+// (fmv.c).  The indexed loads and shifts suit Zba, the population count
+// Zbb and the loop as a whole the vectorizer.
+//
+
+#ifndef FMV_H
+#define FMV_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint64_t (*fmv_sum_t) (const uint32_t *, const uint64_t *, size_t);
+
+uint64_t fmv_sum_base (const uint32_t *, const uint64_t *, size_t);
+uint64_t fmv_sum_zba_zbb (const uint32_t *, const uint64_t *, size_t);
+uint64_t fmv_sum_v (const uint32_t *, const uint64_t *, size_t);
+
+static inline uint64_t
+fmv_sum_body (const uint32_t *idx, const uint64_t *tab, size_t n)
+{
+  uint64_t sum = 0;
+
+  for (size_t i = 0; i < n; i++)
+    sum += (tab[idx[i]] >> 3) + __builtin_popcountll (tab[i]);
+  return sum;
+}
+
+#endif
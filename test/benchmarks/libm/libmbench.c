@@ -0,0 +1,155 @@
+// See LICENSE for license details.
+
+//**************************************************************************
+// libm throughput benchmark
+//--------------------------------------------------------------------------
+//
+// Usage: libmbench <kernel> <iterations>, or no arguments to list the
+// kernels.  Every iteration makes exactly one libm call, so the
+// instruction count difference between two iteration counts is the cost
+// of one call for the ABI the program was built for.
+//
+// By default every kernel is linked in.  Building with -DONLY_KERNEL and
+// -DONLY_<kernel> links in just that kernel (and -DONLY_KERNEL alone
+// none), which lets the harness attribute code size to each function,
+// including the soft-float support routines it pulls in.
+//
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef ONLY_KERNEL
+#define ALL_KERNELS
+#endif
+
+#define INPUTS 16
+
+/* Arguments are read through volatile pointers so the calls cannot be
+   constant folded or hoisted out of the loop.  */
+static const double din[INPUTS] = {
+  0.125, 0.25, 0.5, 0.75, 1.0, 1.25, 1.5, 1.75,
+  2.0, 2.5, 3.0, 3.5, 4.0, 5.0, 6.0, 7.5,
+};
+static const float fin[INPUTS] = {
+  0.125f, 0.25f, 0.5f, 0.75f, 1.0f, 1.25f, 1.5f, 1.75f,
+  2.0f, 2.5f, 3.0f, 3.5f, 4.0f, 5.0f, 6.0f, 7.5f,
+};
+static const double *volatile dp = din;
+static const float *volatile fp = fin;
+static volatile double dsink;
+static volatile float fsink;
+
+#define DEFINE_UNARY(name, in, sink) \
+  static void __attribute__ ((unused)) \
+  run_##name (unsigned long n) \
+  { \
+    for (unsigned long i = 0; i < n; i++) \
+      sink += name (in[i % INPUTS]); \
+  }
+
+#define DEFINE_BINARY(name, in, sink) \
+  static void __attribute__ ((unused)) \
+  run_##name (unsigned long n) \
+  { \
+    for (unsigned long i = 0; i < n; i++) \
+      sink += name (in[i % INPUTS], in[(i + 5) % INPUTS]); \
+  }
+
+#define DEFINE_TERNARY(name, in, sink) \
+  static void __attribute__ ((unused)) \
+  run_##name (unsigned long n) \
+  { \
+    for (unsigned long i = 0; i < n; i++) \
+      sink += name (in[i % INPUTS], in[(i + 5) % INPUTS], \
+		    in[(i + 11) % INPUTS]); \
+  }
+
+DEFINE_UNARY (sin, dp, dsink)
+DEFINE_UNARY (cos, dp, dsink)
+DEFINE_UNARY (exp, dp, dsink)
+DEFINE_UNARY (log, dp, dsink)
+DEFINE_BINARY (pow, dp, dsink)
+DEFINE_UNARY (sqrt, dp, dsink)
+DEFINE_TERNARY (fma, dp, dsink)
+DEFINE_UNARY (sinf, fp, fsink)
+DEFINE_UNARY (cosf, fp, fsink)
+DEFINE_UNARY (expf, fp, fsink)
+DEFINE_UNARY (logf, fp, fsink)
+DEFINE_BINARY (powf, fp, fsink)
+DEFINE_UNARY (sqrtf, fp, fsink)
+DEFINE_TERNARY (fmaf, fp, fsink)
+
+static const struct
+{
+  const char *name;
+  void (*run) (unsigned long);
+} kernels[] = {
+#if defined ALL_KERNELS || defined ONLY_sin
+  { "sin", run_sin },
+#endif
+#if defined ALL_KERNELS || defined ONLY_cos
+  { "cos", run_cos },
+#endif
+#if defined ALL_KERNELS || defined ONLY_exp
+  { "exp", run_exp },
+#endif
+#if defined ALL_KERNELS || defined ONLY_log
+  { "log", run_log },
+#endif
+#if defined ALL_KERNELS || defined ONLY_pow
+  { "pow", run_pow },
+#endif
+#if defined ALL_KERNELS || defined ONLY_sqrt
+  { "sqrt", run_sqrt },
+#endif
+#if defined ALL_KERNELS || defined ONLY_fma
+  { "fma", run_fma },
+#endif
+#if defined ALL_KERNELS || defined ONLY_sinf
+  { "sinf", run_sinf },
+#endif
+#if defined ALL_KERNELS || defined ONLY_cosf
+  { "cosf", run_cosf },
+#endif
+#if defined ALL_KERNELS || defined ONLY_expf
+  { "expf", run_expf },
+#endif
+#if defined ALL_KERNELS || defined ONLY_logf
+  { "logf", run_logf },
+#endif
+#if defined ALL_KERNELS || defined ONLY_powf
+  { "powf", run_powf },
+#endif
+#if defined ALL_KERNELS || defined ONLY_sqrtf
+  { "sqrtf", run_sqrtf },
+#endif
+#if defined ALL_KERNELS || defined ONLY_fmaf
+  { "fmaf", run_fmaf },
+#endif
+  { NULL, NULL }
+};
+
+int
+main (int argc, char **argv)
+{
+  size_t i;
+
+  if (argc < 3)
+    {
+      for (i = 0; kernels[i].name; i++)
+	printf ("%s\n", kernels[i].name);
+      return 0;
+    }
+
+  for (i = 0; kernels[i].name; i++)
+    if (strcmp (kernels[i].name, argv[1]) == 0)
+      {
+	kernels[i].run (strtoul (argv[2], NULL, 0));
+	return 0;
+      }
+
+  fprintf (stderr, "unknown kernel %s\n", argv[1]);
+  return 1;
+}
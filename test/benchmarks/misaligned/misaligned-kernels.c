@@ -0,0 +1,188 @@
+// See LICENSE for license details.
+
+//**************************************************************************
+// Misaligned access kernels
+//--------------------------------------------------------------------------
+//
+// Usage: misaligned-kernels <kernel> <iterations>, or no arguments to list
+// the kernels.  Every kernel prints a checksum, which must not depend on
+// -mstrict-align, and the bench.h result line of its loop.
+//
+// The kernels access multi-byte values at arbitrary byte offsets through
+// memcpy, the portable way to write such code: with -mstrict-align GCC
+// assembles them from byte accesses, with -mno-strict-align it uses
+// (possibly misaligned) word accesses.  trap does exactly TRAP_LOADS
+// misaligned loads per iteration in inline assembly whatever the flags,
+// so the harness can work out the cost of one emulated access.
+//
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+
+#define N 4096
+#define RECORD_SIZE 13
+#define TRAP_LOADS 256
+
+static uint8_t src[N + 16], dst[N + 16];
+
+static inline uint64_t
+load64 (const uint8_t *p)
+{
+  uint64_t v;
+  memcpy (&v, p, sizeof v);
+  return v;
+}
+
+static inline uint32_t
+load32 (const uint8_t *p)
+{
+  uint32_t v;
+  memcpy (&v, p, sizeof v);
+  return v;
+}
+
+static inline uint16_t
+load16 (const uint8_t *p)
+{
+  uint16_t v;
+  memcpy (&v, p, sizeof v);
+  return v;
+}
+
+static inline void
+store64 (uint8_t *p, uint64_t v)
+{
+  memcpy (p, &v, sizeof v);
+}
+
+// Copy between buffers whose offsets differ from each other and from
+// their alignment, scrambling the data so it is not a plain memcpy.
+static uint64_t
+copy (unsigned long iters)
+{
+  for (unsigned long it = 0; it < iters; it++)
+    for (size_t i = 0; i + 8 <= N; i += 8)
+      {
+	uint64_t v = load64 (src + 1 + i);
+
+	store64 (dst + 3 + i, v ^ (0x9e3779b97f4a7c15ull + it));
+      }
+  return load64 (dst + 3) ^ load64 (dst + 3 + N / 2) ^ load64 (dst + N - 5);
+}
+
+// Decode packed records: an 8-bit type, a 32-bit length and a 64-bit
+// value, without padding.
+static uint64_t
+parse (unsigned long iters)
+{
+  uint64_t sum = 0;
+
+  for (unsigned long it = 0; it < iters; it++)
+    for (size_t i = 0; i + RECORD_SIZE <= N; i += RECORD_SIZE)
+      {
+	const uint8_t *rec = src + i;
+
+	if (rec[0] & 1)
+	  sum += load64 (rec + 5) >> (rec[0] & 7);
+	else
+	  sum ^= load32 (rec + 1) + it;
+      }
+  return sum;
+}
+
+// A 16-bit ones' complement checksum, as for IP, starting at an odd
+// offset.
+static uint64_t
+csum (unsigned long iters)
+{
+  uint64_t sum = 0;
+
+  for (unsigned long it = 0; it < iters; it++)
+    {
+      uint64_t acc = it;
+
+      for (size_t i = 1; i + 8 <= N; i += 8)
+	{
+	  uint64_t v = load64 (src + i);
+
+	  acc += (v & 0xffffffff) + (v >> 32);
+	}
+      acc += load16 (src + N - 7);
+      while (acc >> 16)
+	acc = (acc & 0xffff) + (acc >> 16);
+      sum += acc;
+    }
+  return sum;
+}
+
+static uint64_t
+trap (unsigned long iters)
+{
+  uint64_t sum = 0;
+
+  for (unsigned long it = 0; it < iters; it++)
+    for (size_t i = 0; i < TRAP_LOADS; i++)
+      {
+	const uint8_t *p = src + 1 + (i % 64) * 8;
+	unsigned long v;
+
+#if __riscv_xlen == 64
+	asm volatile ("ld %0, 0(%1)" : "=r"(v) : "r"(p) : "memory");
+#else
+	asm volatile ("lw %0, 0(%1)" : "=r"(v) : "r"(p) : "memory");
+#endif
+	sum += v;
+      }
+  return sum;
+}
+
+static const struct
+{
+  const char *name;
+  uint64_t (*run) (unsigned long);
+} kernels[] = {
+  { "copy", copy },
+  { "parse", parse },
+  { "csum", csum },
+  { "trap", trap },
+};
+
+#define KERNEL_COUNT (sizeof (kernels) / sizeof (kernels[0]))
+
+int
+main (int argc, char **argv)
+{
+  size_t i;
+
+  if (argc < 3)
+    {
+      for (i = 0; i < KERNEL_COUNT; i++)
+	printf ("%s\n", kernels[i].name);
+      return 0;
+    }
+
+  for (i = 0; i < sizeof src; i++)
+    src[i] = (uint8_t) (i * 167 + (i >> 7));
+
+  for (i = 0; i < KERNEL_COUNT; i++)
+    if (strcmp (kernels[i].name, argv[1]) == 0)
+      {
+	unsigned long iters = strtoul (argv[2], NULL, 0);
+	bench_region_t region;
+	uint64_t sum;
+
+	bench_begin (&region);
+	sum = kernels[i].run (iters);
+	bench_end (&region);
+	printf ("%s %016llx\n", argv[1], (unsigned long long) sum);
+	bench_report (argv[1], &region, iters);
+	return 0;
+      }
+
+  fprintf (stderr, "unknown kernel %s\n", argv[1]);
+  return 1;
+}
@@ -0,0 +1,32 @@
+// See LICENSE for license details.
+
+//**************************************************************************
+// Precompiled header benchmark: typical translation unit
+//--------------------------------------------------------------------------
+//
+// Includes <bits/stdc++.h> first, so the libstdc++ precompiled header can
+// be used, followed by a small amount of code; compiling it is dominated by
+// parsing the headers, which is what the PCH saves.
+//
+
+#include <bits/stdc++.h>
+
+std::map<std::string, std::vector<int>>
+index_words (const std::vector<std::string> &words)
+{
+  std::map<std::string, std::vector<int>> index;
+
+  for (size_t i = 0; i < words.size (); i++)
+    index[words[i]].push_back (static_cast<int> (i));
+  return index;
+}
+
+std::string
+most_common (const std::vector<std::string> &words)
+{
+  auto index = index_words (words);
+  auto best = std::max_element (index.begin (), index.end (),
+				[] (const auto &a, const auto &b)
+				{ return a.second.size () < b.second.size (); });
+  return best == index.end () ? std::string () : best->first;
+}
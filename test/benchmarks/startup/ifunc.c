@@ -0,0 +1,59 @@
+// See LICENSE for license details.
+
+//**************************************************************************
+// Program startup cost benchmark: IRELATIVE relocations
+//--------------------------------------------------------------------------
+//
+// Every function below is an ifunc, so each one costs an IRELATIVE
+// relocation and a resolver call during startup (or on first call with
+// lazy binding).  glibc only; musl does not support ifunc.
+//
+
+#include <stddef.h>
+
+#define IFUNC_COUNT 32
+
+typedef int (*impl_t) (int);
+
+static int impl_generic (int x) { return x + 1; }
+static int impl_fast (int x) { return x + 1; }
+
+/* The resolver only relies on the hwcap argument, which every glibc
+   version passes on RISC-V.  */
+static impl_t
+resolve (unsigned long hwcap)
+{
+  return (hwcap & (1UL << ('C' - 'A'))) ? impl_fast : impl_generic;
+}
+
+#define DEFINE_IFUNC(n) \
+  int ifunc_##n (int) __attribute__ ((ifunc ("resolve_" #n))); \
+  static impl_t resolve_##n (unsigned long hwcap) { return resolve (hwcap); }
+
+#define DEFINE_IFUNC8(n) \
+  DEFINE_IFUNC (n##0) DEFINE_IFUNC (n##1) DEFINE_IFUNC (n##2) \
+  DEFINE_IFUNC (n##3) DEFINE_IFUNC (n##4) DEFINE_IFUNC (n##5) \
+  DEFINE_IFUNC (n##6) DEFINE_IFUNC (n##7)
+
+DEFINE_IFUNC8 (0)
+DEFINE_IFUNC8 (1)
+DEFINE_IFUNC8 (2)
+DEFINE_IFUNC8 (3)
+
+/* Take the addresses so the static link keeps every IRELATIVE
+   relocation, not only those of the called functions.  */
+impl_t ifunc_table[IFUNC_COUNT] = {
+  ifunc_00, ifunc_01, ifunc_02, ifunc_03, ifunc_04, ifunc_05, ifunc_06,
+  ifunc_07, ifunc_10, ifunc_11, ifunc_12, ifunc_13, ifunc_14, ifunc_15,
+  ifunc_16, ifunc_17, ifunc_20, ifunc_21, ifunc_22, ifunc_23, ifunc_24,
+  ifunc_25, ifunc_26, ifunc_27, ifunc_30, ifunc_31, ifunc_32, ifunc_33,
+  ifunc_34, ifunc_35, ifunc_36, ifunc_37,
+};
+
+void
+bench_touch (void)
+{
+  int x = 0;
+  for (size_t i = 0; i < IFUNC_COUNT; i++)
+    x = ifunc_table[i] (x);
+}
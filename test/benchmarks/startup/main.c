@@ -0,0 +1,24 @@
+// See LICENSE for license details.
+
+//**************************************************************************
+// Program startup cost benchmark
+//--------------------------------------------------------------------------
+//
+// main leaves through _exit right away, so the instructions counted for a
+// run without arguments are (almost) exactly those spent between exec and
+// main: ld.so relocation processing, IRELATIVE resolution, TLS setup and
+// libc initialization.  With an argument, every imported function is
+// called once first, which adds the cost of lazy PLT binding.
+//
+
+#include <unistd.h>
+
+void bench_touch (void);
+
+int
+main (int argc, char **argv)
+{
+  if (argc > 1)
+    bench_touch ();
+  _exit (0);
+}
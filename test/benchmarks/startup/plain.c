@@ -0,0 +1,27 @@
+// See LICENSE for license details.
+
+//**************************************************************************
+// Program startup cost benchmark: plain libc user
+//--------------------------------------------------------------------------
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static int
+compare (const void *a, const void *b)
+{
+  return *(const int *) a - *(const int *) b;
+}
+
+void
+bench_touch (void)
+{
+  static int values[4] = { 3, 1, 2, 0 };
+  static char buf[32];
+  memset (buf, 0, sizeof (buf));
+  memcpy (buf, "startup", strlen ("startup"));
+  qsort (values, 4, sizeof (int), compare);
+  if (getpid () == 0)
+    abort ();
+}
@@ -0,0 +1,21 @@
+// See LICENSE for license details.
+
+//**************************************************************************
+// Program startup cost benchmark: TLS setup
+//--------------------------------------------------------------------------
+//
+// A large initialized TLS block (copied into the initial thread's TLS area
+// at startup) plus a zero-initialized one.
+//
+
+#define TLS_WORDS 4096
+
+__thread long tls_init[TLS_WORDS] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+__thread long tls_zero[TLS_WORDS];
+
+void
+bench_touch (void)
+{
+  for (int i = 0; i < TLS_WORDS; i += 64)
+    tls_zero[i] = tls_init[i & 7];
+}
@@ -0,0 +1,145 @@
+// See LICENSE for license details.
+
+//**************************************************************************
+// VLEN scaling kernels
+//--------------------------------------------------------------------------
+//
+// Usage: vlen-kernels <kernel> <iterations>, or no arguments to list the
+// kernels.  Every kernel prints a checksum that must not depend on VLEN.
+// The auto-vectorized kernels are vector-length agnostic and should need
+// fewer instructions on wider hardware; fixed_vl4 strip-mines with at
+// most four elements per vsetvl, like code tuned for one VLEN, and does
+// not scale.
+//
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef __riscv_vector
+#include <riscv_vector.h>
+#endif
+
+#define N 4096
+
+static int32_t a[N], b[N], c[N];
+static uint8_t src[N], dst[N];
+static uint16_t idx[N];
+
+static uint64_t
+checksum32 (const int32_t *p, size_t n)
+{
+  uint64_t sum = 0;
+  for (size_t i = 0; i < n; i++)
+    sum = sum * 31 + (uint32_t) p[i];
+  return sum;
+}
+
+static uint64_t
+add_i32 (unsigned long iters)
+{
+  for (unsigned long it = 0; it < iters; it++)
+    for (size_t i = 0; i < N; i++)
+      c[i] = (int32_t) ((uint32_t) a[i] + (uint32_t) b[i] * (uint32_t) it);
+  return checksum32 (c, N);
+}
+
+static uint64_t
+dot_i32 (unsigned long iters)
+{
+  uint64_t sum = 0;
+  for (unsigned long it = 0; it < iters; it++)
+    for (size_t i = 0; i < N; i++)
+      sum += (uint64_t) ((int64_t) a[i] * b[i]);
+  return sum;
+}
+
+static uint64_t
+copy_u8 (unsigned long iters)
+{
+  uint64_t sum = 0;
+  for (unsigned long it = 0; it < iters; it++)
+    {
+      for (size_t i = 0; i < N; i++)
+	dst[i] = src[i] ^ (uint8_t) it;
+      sum += dst[it % N];
+    }
+  return sum;
+}
+
+static uint64_t
+gather_i32 (unsigned long iters)
+{
+  for (unsigned long it = 0; it < iters; it++)
+    for (size_t i = 0; i < N; i++)
+      c[i] = (int32_t) ((uint32_t) a[idx[i]] + (uint32_t) it);
+  return checksum32 (c, N);
+}
+
+static uint64_t
+fixed_vl4 (unsigned long iters)
+{
+  for (unsigned long it = 0; it < iters; it++)
+    {
+#ifdef __riscv_vector
+      for (size_t i = 0, vl; i < N; i += vl)
+	{
+	  vl = __riscv_vsetvl_e32m1 (N - i < 4 ? N - i : 4);
+	  vint32m1_t va = __riscv_vle32_v_i32m1 (&a[i], vl);
+	  vint32m1_t vb = __riscv_vle32_v_i32m1 (&b[i], vl);
+	  va = __riscv_vmacc_vx_i32m1 (va, (int32_t) it, vb, vl);
+	  __riscv_vse32_v_i32m1 (&c[i], va, vl);
+	}
+#else
+      for (size_t i = 0; i < N; i++)
+	c[i] = (int32_t) ((uint32_t) a[i] + (uint32_t) b[i] * (uint32_t) it);
+#endif
+    }
+  return checksum32 (c, N);
+}
+
+static const struct
+{
+  const char *name;
+  uint64_t (*run) (unsigned long);
+} kernels[] = {
+  { "add_i32", add_i32 },
+  { "dot_i32", dot_i32 },
+  { "copy_u8", copy_u8 },
+  { "gather_i32", gather_i32 },
+  { "fixed_vl4", fixed_vl4 },
+};
+
+#define KERNEL_COUNT (sizeof (kernels) / sizeof (kernels[0]))
+
+int
+main (int argc, char **argv)
+{
+  size_t i;
+
+  if (argc < 3)
+    {
+      for (i = 0; i < KERNEL_COUNT; i++)
+	printf ("%s\n", kernels[i].name);
+      return 0;
+    }
+
+  for (i = 0; i < N; i++)
+    {
+      a[i] = (int32_t) (i * 2654435761u);
+      b[i] = (int32_t) (i ^ 0x5a5a);
+      src[i] = (uint8_t) (i * 7);
+      idx[i] = (uint16_t) ((i * 97) % N);
+    }
+
+  for (i = 0; i < KERNEL_COUNT; i++)
+    if (strcmp (kernels[i].name, argv[1]) == 0)
+      {
+	uint64_t sum = kernels[i].run (strtoul (argv[2], NULL, 0));
+	printf ("%s %016llx\n", argv[1], (unsigned long long) sum);
+	return 0;
+      }
+
+  fprintf (stderr, "unknown kernel %s\n", argv[1]);
+  return 1;
+}